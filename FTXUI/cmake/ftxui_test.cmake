@@ -50,6 +50,7 @@ add_executable(ftxui-tests
   src/ftxui/dom/underlined_test.cpp
   src/ftxui/dom/vbox_test.cpp
   src/ftxui/screen/color_test.cpp
+  src/ftxui/screen/screen_test.cpp
   src/ftxui/screen/string_test.cpp
 )
 
@@ -33,8 +33,10 @@ struct Event {
   static Event Character(wchar_t);
   static Event Special(std::string);
   static Event Mouse(std::string, Mouse mouse);
+  static Event Paste(const std::string& content);
   static Event CursorPosition(std::string, int x, int y);  // Internal
   static Event CursorShape(std::string, int shape);        // Internal
+  static Event ModeReport(std::string, int mode, int value);  // Internal
 
   // --- Arrow ---
   static const Event ArrowLeft;
@@ -109,6 +111,9 @@ struct Event {
   bool is_mouse() const { return type_ == Type::Mouse; }
   struct Mouse& mouse() { return data_.mouse; }
 
+  bool is_paste() const { return type_ == Type::Paste; }
+  std::string paste() const;
+
   // --- Internal Method section -----------------------------------------------
   bool is_cursor_position() const { return type_ == Type::CursorPosition; }
   int cursor_x() const { return data_.cursor.x; }
@@ -117,6 +122,10 @@ struct Event {
   bool is_cursor_shape() const { return type_ == Type::CursorShape; }
   int cursor_shape() const { return data_.cursor_shape; }
 
+  bool is_mode_report() const { return type_ == Type::ModeReport; }
+  int mode_report_mode() const { return data_.mode_report.mode; }
+  int mode_report_value() const { return data_.mode_report.value; }
+
   // Debug
   std::string DebugString() const;
 
@@ -132,6 +141,8 @@ struct Event {
     Mouse,
     CursorPosition,
     CursorShape,
+    ModeReport,
+    Paste,
   };
   Type type_ = Type::Unknown;
 
@@ -140,10 +151,16 @@ struct Event {
     int y = 0;
   };
 
+  struct Mode {
+    int mode = 0;
+    int value = 0;
+  };
+
   union {
     struct Mouse mouse;
     struct Cursor cursor;
     int cursor_shape;
+    struct Mode mode_report;
   } data_ = {};
 
   std::string input_;
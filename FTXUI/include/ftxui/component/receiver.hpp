@@ -5,8 +5,11 @@
 #define FTXUI_COMPONENT_RECEIVER_HPP_
 
 #include <algorithm>           // for copy, max
-#include <atomic>              // for atomic, __atomic_base
-#include <condition_variable>  // for condition_variable
+#include <array>               // for array
+#include <atomic>              // for atomic, atomic_thread_fence
+#include <chrono>              // for time_point
+#include <condition_variable>  // for condition_variable, cv_status
+#include <cstddef>             // for size_t
 #include <memory>              // for unique_ptr, make_unique
 #include <mutex>               // for mutex, unique_lock
 #include <queue>               // for queue
@@ -67,70 +70,196 @@ class SenderImpl {
   ReceiverImpl<T>* receiver_;
 };
 
+// A multi-producer single-consumer queue. The elements are stored in a bounded
+// lock-free ring buffer. The consumer only takes the lock to park, when the
+// queue is empty. The producers only take it to wake it up, and when the ring
+// is full, to spill into an unbounded overflow queue.
 template <class T>
 class ReceiverImpl {
  public:
   Sender<T> MakeSender() {
-    std::unique_lock<std::mutex> lock(mutex_);
     senders_++;
     return std::unique_ptr<SenderImpl<T>>(new SenderImpl<T>(this));
   }
-  ReceiverImpl() = default;
+  ReceiverImpl() {
+    for (size_t i = 0; i < kCapacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
 
   bool Receive(T* t) {
-    while (senders_ || !queue_.empty()) {
-      std::unique_lock<std::mutex> lock(mutex_);
-      if (queue_.empty()) {
-        notifier_.wait(lock);
+    while (true) {
+      if (Pop(t)) {
+        return true;
       }
-      if (queue_.empty()) {
-        continue;
+      if (!senders_) {
+        return Pop(t);
       }
-      *t = std::move(queue_.front());
-      queue_.pop();
-      return true;
+      Park([&](std::unique_lock<std::mutex>& lock) {
+        notifier_.wait(lock);
+        return true;
+      });
     }
-    return false;
   }
 
-  bool ReceiveNonBlocking(T* t) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (queue_.empty()) {
-      return false;
+  // Wait for an element up until `deadline`. Return false if none was
+  // received.
+  template <class Clock, class Duration>
+  bool ReceiveUntil(T* t,
+                    const std::chrono::time_point<Clock, Duration>& deadline) {
+    while (true) {
+      if (Pop(t)) {
+        return true;
+      }
+      if (!senders_) {
+        return Pop(t);
+      }
+      const bool woken = Park([&](std::unique_lock<std::mutex>& lock) {
+        return notifier_.wait_until(lock, deadline) ==
+               std::cv_status::no_timeout;
+      });
+      if (!woken) {
+        return Pop(t);
+      }
     }
-    *t = queue_.front();
-    queue_.pop();
-    return true;
   }
 
-  bool HasPending() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    return !queue_.empty();
-  }
+  bool ReceiveNonBlocking(T* t) { return Pop(t); }
+
+  bool HasPending() { return !Empty(); }
 
   bool HasQuitted() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    return queue_.empty() && !senders_;
+    // Elements are pushed before their sender is released, so `senders_` must
+    // be checked first.
+    if (senders_) {
+      return false;
+    }
+    return Empty();
   }
 
  private:
   friend class SenderImpl<T>;
 
+  static constexpr size_t kCapacity = 1024;  // Must be a power of two.
+
+  struct Cell {
+    // Equal to the position for an empty cell, and to the position + 1 once
+    // the element is written.
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
   void Receive(T t) {
-    {
+    if (overflowed_.load(std::memory_order_acquire) || !TryPush(t)) {
       std::unique_lock<std::mutex> lock(mutex_);
-      queue_.push(std::move(t));
+      overflow_.push(std::move(t));
+      overflowed_.store(true, std::memory_order_release);
     }
-    notifier_.notify_one();
+    Wake();
   }
 
   void ReleaseSender() {
     senders_--;
+    Wake();
+  }
+
+  // Move `t` into the ring buffer, unless it is full.
+  bool TryPush(T& t) {
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    while (true) {
+      cell = &cells_[position & (kCapacity - 1)];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (enqueue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (sequence < position) {
+        return false;  // Full: the consumer hasn't freed this cell yet.
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::move(t);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Only called by the consumer.
+  bool Pop(T* t) {
+    Cell& cell = cells_[dequeue_position_ & (kCapacity - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) ==
+        dequeue_position_ + 1) {
+      *t = std::move(cell.value);
+      cell.sequence.store(dequeue_position_ + kCapacity,
+                          std::memory_order_release);
+      dequeue_position_++;
+      return true;
+    }
+
+    // The overflow contains elements sent after the ones in the ring buffer,
+    // including the ones still being written.
+    if (!overflowed_.load(std::memory_order_acquire) ||
+        enqueue_position_.load(std::memory_order_acquire) !=
+            dequeue_position_) {
+      return false;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (overflow_.empty()) {
+      return false;
+    }
+    *t = std::move(overflow_.front());
+    overflow_.pop();
+    if (overflow_.empty()) {
+      overflowed_.store(false, std::memory_order_release);
+    }
+    return true;
+  }
+
+  bool Empty() {
+    const Cell& cell = cells_[dequeue_position_ & (kCapacity - 1)];
+    return cell.sequence.load(std::memory_order_acquire) !=
+               dequeue_position_ + 1 &&
+           !overflowed_.load(std::memory_order_acquire);
+  }
+
+  // Sleep until a producer sends an element or leaves. Return false on
+  // timeout.
+  template <class Wait>
+  bool Park(Wait wait) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    parked_.store(true, std::memory_order_relaxed);
+    // Pairs with the fence in Wake(): either the producer sees `parked_`, or
+    // the consumer sees the new state.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool woken = true;
+    if (Empty() && senders_) {
+      woken = wait(lock);
+    }
+    parked_.store(false, std::memory_order_relaxed);
+    return woken;
+  }
+
+  void Wake() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!parked_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    // Taking the lock guarantees the consumer is waiting, and not in between
+    // checking the queue and waiting.
+    { std::unique_lock<std::mutex> lock(mutex_); }
     notifier_.notify_one();
   }
 
+  std::array<Cell, kCapacity> cells_;
+  std::atomic<size_t> enqueue_position_{0};
+  size_t dequeue_position_ = 0;
+
   std::mutex mutex_;
-  std::queue<T> queue_;
+  std::queue<T> overflow_;
+  std::atomic<bool> overflowed_{false};
+  std::atomic<bool> parked_{false};
   std::condition_variable notifier_;
   std::atomic<int> senders_{0};
 };
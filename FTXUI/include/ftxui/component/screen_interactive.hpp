@@ -5,9 +5,11 @@
 #define FTXUI_COMPONENT_SCREEN_INTERACTIVE_HPP
 
 #include <atomic>                        // for atomic
+#include <condition_variable>            // for condition_variable
 #include <ftxui/component/receiver.hpp>  // for Receiver, Sender
 #include <functional>                    // for function
 #include <memory>                        // for shared_ptr
+#include <mutex>                         // for mutex
 #include <string>                        // for string
 #include <thread>                        // for thread
 
@@ -42,6 +44,9 @@ class ScreenInteractive : public Screen {
 
   // Options. Must be called before Loop().
   void TrackMouse(bool enable = true);
+  void TrackPaste(bool enable = true);
+  void SetMaxFPS(int fps);
+  void SetLowBandwidth(bool enable = true);
 
   // Return the currently active screen, nullptr if none.
   static ScreenInteractive* Active();
@@ -58,6 +63,13 @@ class ScreenInteractive : public Screen {
 
   CapturedMouse CaptureMouse();
 
+  // Whether the terminal doesn't keep up with the output. Frames are skipped
+  // until it drains. This is useful to warn users of a slow connection.
+  bool IsCongested() const { return congested_; }
+
+  // The number of bytes printed for the last frame.
+  size_t LastFrameSize() const { return last_frame_size_; }
+
   // Decorate a function. The outputted one will execute similarly to the
   // inputted one, but with the currently active screen terminal hooks
   // temporarily uninstalled.
@@ -93,9 +105,11 @@ class ScreenInteractive : public Screen {
   bool HandleSelection(bool handled, Event event);
   void RefreshSelection();
   void Draw(Component component);
+  bool WriteOutput(bool blocking);
   void ResetCursorPosition();
 
   void Signal(int signal);
+  void AnimationListener(Sender<Task> out);
 
   ScreenInteractive* suspended_screen_ = nullptr;
   enum class Dimension {
@@ -112,6 +126,7 @@ class ScreenInteractive : public Screen {
   const bool use_alternative_screen_;
 
   bool track_mouse_ = true;
+  bool track_paste_ = false;
 
   Sender<Task> task_sender_;
   Receiver<Task> task_receiver_;
@@ -123,6 +138,10 @@ class ScreenInteractive : public Screen {
   std::thread event_listener_;
   std::thread animation_listener_;
   bool animation_requested_ = false;
+  // Wakes up the animation listener. It sleeps while no frame is requested.
+  std::mutex animation_mutex_;
+  std::condition_variable animation_notifier_;
+  bool animation_pending_ = false;  // Guarded by animation_mutex_.
   animation::TimePoint previous_animation_time_;
 
   int cursor_x_ = 1;
@@ -131,9 +150,33 @@ class ScreenInteractive : public Screen {
   std::uint64_t frame_count_ = 0;
   bool mouse_captured = false;
   bool previous_frame_resized_ = false;
+  // Counts the frames drawn, to request the cursor position periodically.
+  int dsr_counter_ = -3;
 
   bool frame_valid_ = false;
 
+  // Tasks received less than `min_frame_interval_` after the previous frame
+  // are handled before drawing the next one.
+  animation::Clock::duration min_frame_interval_{0};
+  animation::TimePoint previous_frame_time_;
+
+  // The last frame printed to the terminal. Used to print only the damaged
+  // cells of the next one.
+  Screen previous_frame_{0, 0};
+
+  // The frame being printed. Its capacity is reused from frame to frame.
+  std::string output_buffer_;
+  // The part of `output_buffer_` already written. The rest must be written
+  // before the next frame.
+  size_t output_written_ = 0;
+  size_t last_frame_size_ = 0;
+  bool congested_ = false;
+  bool low_bandwidth_ = false;
+
+  // Whether the terminal reported supporting synchronized updates. Frames are
+  // then displayed atomically, without tearing.
+  bool synchronized_update_ = false;
+
   bool force_handle_ctrl_c_ = true;
   bool force_handle_ctrl_z_ = true;
 
@@ -318,6 +318,8 @@ class Color {
   bool operator!=(const Color& rhs) const;
 
   std::string Print(bool is_background_color) const;
+  // Same as Print(), but appending to `output` without allocating.
+  void PrintTo(std::string& output, bool is_background_color) const;
   bool IsOpaque() const { return alpha_ == 255; }
 
  private:
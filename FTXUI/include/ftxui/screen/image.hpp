@@ -4,11 +4,10 @@
 #ifndef FTXUI_SCREEN_IMAGE_HPP
 #define FTXUI_SCREEN_IMAGE_HPP
 
-#include <string>  // for string, basic_string, allocator
 #include <vector>  // for vector
 
 #include "ftxui/screen/box.hpp"    // for Box
-#include "ftxui/screen/pixel.hpp"  // for Pixel
+#include "ftxui/screen/pixel.hpp"  // for Pixel, Glyph
 
 namespace ftxui {
 
@@ -21,8 +20,8 @@ class Image {
   Image(int dimx, int dimy);
 
   // Access a character in the grid at a given position.
-  std::string& at(int x, int y);
-  const std::string& at(int x, int y) const;
+  Glyph& at(int x, int y);
+  const Glyph& at(int x, int y) const;
 
   // Access a cell (Pixel) in the grid at a given position.
   Pixel& PixelAt(int x, int y);
@@ -40,7 +39,8 @@ class Image {
  protected:
   int dimx_;
   int dimy_;
-  std::vector<std::vector<Pixel>> pixels_;
+  // The pixels, row by row: the pixel (x,y) is at index y * dimx_ + x.
+  std::vector<Pixel> pixels_;
 };
 
 }  // namespace ftxui
@@ -4,12 +4,58 @@
 #ifndef FTXUI_SCREEN_PIXEL_HPP
 #define FTXUI_SCREEN_PIXEL_HPP
 
+#include <cstddef>                 // for size_t
 #include <cstdint>                 // for uint8_t
 #include <string>                  // for string, basic_string, allocator
+#include <string_view>             // for string_view
 #include "ftxui/screen/color.hpp"  // for Color, Color::Default
 
 namespace ftxui {
 
+/// @brief The grapheme cluster drawn by a Pixel.
+///
+/// Short clusters, which are nearly all of them, are stored inline. The rare
+/// longer ones are interned into a side table shared by every Glyph, so that a
+/// Glyph never owns heap memory and can be copied and compared as plain bytes.
+/// The width of the glyph is computed once, when it is built.
+/// @ingroup screen
+class Glyph {
+ public:
+  Glyph() : size_(0), width_(0) {}
+  Glyph(std::string_view str);  // NOLINT
+  Glyph(const std::string& str) : Glyph(std::string_view(str)) {}  // NOLINT
+  Glyph(const char* str) : Glyph(std::string_view(str)) {}         // NOLINT
+
+  std::string_view view() const;
+  operator std::string_view() const { return view(); }          // NOLINT
+  operator std::string() const { return std::string(view()); }  // NOLINT
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return view().size(); }
+  // The number of cells taken by the glyph, saturated to 3.
+  int width() const { return width_; }
+  char operator[](size_t index) const { return view()[index]; }
+
+  bool operator==(const Glyph& other) const;
+  bool operator!=(const Glyph& other) const { return !operator==(other); }
+  bool operator==(std::string_view other) const { return view() == other; }
+  bool operator!=(std::string_view other) const { return view() != other; }
+  bool operator==(const std::string& other) const { return view() == other; }
+  bool operator!=(const std::string& other) const { return view() != other; }
+  bool operator==(const char* other) const { return view() == other; }
+  bool operator!=(const char* other) const { return view() != other; }
+
+ private:
+  static constexpr size_t kInlineCapacity = 7;
+  static constexpr uint8_t kInterned = 0xF;
+
+  // The bytes of the glyph, zero padded. For interned glyphs, the index into
+  // the side table.
+  char data_[kInlineCapacity] = {};
+  uint8_t size_ : 4;
+  uint8_t width_ : 2;
+};
+
 /// @brief A Unicode character and its associated style.
 /// @ingroup screen
 struct Pixel {
@@ -42,7 +88,7 @@ struct Pixel {
 
   // The graphemes stored into the pixel. To support combining characters,
   // like: a?, this can potentially contain multiple codepoints.
-  std::string character = "";
+  Glyph character;
 
   // Colors:
   Color background_color = Color::Default;
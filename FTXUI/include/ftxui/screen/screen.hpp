@@ -33,6 +33,19 @@ class Screen : public Image {
 
   std::string ToString() const;
 
+  // Produce the output updating a terminal displaying `previous` into this
+  // screen, printing only the cells that changed.
+  std::string ToDiffString(const Screen& previous) const;
+
+  // Same as above, appending to `output`. Reusing the same buffer from frame to
+  // frame avoids allocating. With `scroll_region`, the terminal is asked to
+  // scroll the lines which only moved vertically. This requires the screen to
+  // be drawn at the top of the terminal.
+  void ToString(std::string& output) const;
+  void ToDiffString(const Screen& previous,
+                    std::string& output,
+                    bool scroll_region = false) const;
+
   // Print the Screen on to the terminal.
   void Print() const;
 
@@ -64,6 +77,11 @@ class Screen : public Image {
   Cursor cursor() const { return cursor_; }
   void SetCursor(Cursor cursor) { cursor_ = cursor; }
 
+  // Print every style change as a single SGR sequence, either updating the
+  // style or resetting it, whichever is shorter. Saves bytes on slow links.
+  bool compact_style() const { return compact_style_; }
+  void SetCompactStyle(bool compact) { compact_style_ = compact; }
+
   // Store an hyperlink in the screen. Return the id of the hyperlink. The id is
   // used to identify the hyperlink when the user click on it.
   uint8_t RegisterHyperlink(const std::string& link);
@@ -76,6 +94,7 @@ class Screen : public Image {
  protected:
   Cursor cursor_;
   std::vector<std::string> hyperlinks_ = {""};
+  bool compact_style_ = false;
 
   // The current selection style. This is overridden by various dom elements.
   SelectionStyle selection_style_ = [](Pixel& pixel) {
@@ -58,6 +58,34 @@ Event Event::Mouse(std::string input, struct Mouse mouse) {
   return event;
 }
 
+namespace {
+// Bracketed paste markers, sent by the terminal around pasted text.
+const char kPasteStart[] = "\x1B[200~";  // NOLINT
+const char kPasteEnd[] = "\x1B[201~";    // NOLINT
+const size_t kPasteMarkerSize = sizeof(kPasteStart) - 1;
+}  // namespace
+
+/// @brief An event corresponding to text pasted in the terminal, all at once.
+/// Delivered only when bracketed paste is enabled.
+/// @param content The text pasted.
+/// @see ScreenInteractive::TrackPaste
+// static
+Event Event::Paste(const std::string& content) {
+  Event event;
+  event.input_ = kPasteStart + content + kPasteEnd;
+  event.type_ = Type::Paste;
+  return event;
+}
+
+/// @brief The text pasted, for a Paste event.
+std::string Event::paste() const {
+  if (input_.size() < 2 * kPasteMarkerSize) {
+    return "";
+  }
+  return input_.substr(kPasteMarkerSize,
+                       input_.size() - 2 * kPasteMarkerSize);
+}
+
 /// @brief An event corresponding to a terminal DCS (Device Control String).
 // static
 Event Event::CursorShape(std::string input, int shape) {
@@ -68,6 +96,18 @@ Event Event::CursorShape(std::string input, int shape) {
   return event;
 }
 
+/// @brief An event corresponding to a terminal DECRPM (Report Mode), the reply
+/// to a DECRQM (Request Mode).
+// static
+Event Event::ModeReport(std::string input, int mode, int value) {
+  Event event;
+  event.input_ = std::move(input);
+  event.type_ = Type::ModeReport;
+  event.data_.mode_report.mode = mode;    // NOLINT
+  event.data_.mode_report.value = value;  // NOLINT
+  return event;
+}
+
 /// @brief An custom event whose meaning is defined by the user of the library.
 /// @param input An arbitrary sequence of character defined by the developer.
 // static
@@ -261,9 +301,14 @@ std::string Event::DebugString() const {
       out += "})";
       return out;
     }
+    case Type::Paste:
+      return "Event::Paste(\"" + paste() + "\")";
     case Type::CursorShape:
       return "Event::CursorShape(" + input_ + ", " +
              std::to_string(data_.cursor_shape) + ")";
+    case Type::ModeReport:
+      return "Event::ModeReport(" + std::to_string(data_.mode_report.mode) +
+             ", " + std::to_string(data_.mode_report.value) + ")";
     case Type::CursorPosition:
       return "Event::CursorPosition(" + input_ + ", " +
              std::to_string(data_.cursor.x) + ", " +
@@ -372,6 +372,13 @@ class InputBase : public ComponentBase, public InputOption {
     if (event.is_character()) {
       return HandleCharacter(event.character());
     }
+    if (event.is_paste()) {
+      std::string text = event.paste();
+      if (!multiline()) {
+        std::replace(text.begin(), text.end(), '\n', ' ');
+      }
+      return HandleCharacter(text);
+    }
     if (event.is_mouse()) {
       return HandleMouse(event);
     }
@@ -0,0 +1,76 @@
+// Copyright 2025 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#include <benchmark/benchmark.h>
+#include <thread>   // for thread
+#include <utility>  // for move
+
+#include "ftxui/component/receiver.hpp"  // for MakeReceiver, Receiver, Sender
+#include "ftxui/component/task.hpp"      // for Task, AnimationTask
+
+// NOLINTBEGIN
+namespace ftxui {
+
+// Enqueue and dequeue a task from the same thread. The consumer is never
+// parked.
+static void BenchmarkReceiverSameThread(benchmark::State& state) {
+  auto receiver = MakeReceiver<Task>();
+  auto sender = receiver->MakeSender();
+  Task task;
+  while (state.KeepRunning()) {
+    sender->Send(AnimationTask());
+    benchmark::DoNotOptimize(receiver->ReceiveNonBlocking(&task));
+  }
+}
+BENCHMARK(BenchmarkReceiverSameThread);
+
+// Send a task to a thread, and wait for it to be sent back. The consumers are
+// parked in between, so this measures the wakeup latency.
+static void BenchmarkReceiverPingPong(benchmark::State& state) {
+  auto ping = MakeReceiver<Task>();
+  auto pong = MakeReceiver<Task>();
+  auto ping_sender = ping->MakeSender();
+  auto echo = std::thread(
+      [](Receiver<Task> receiver, Sender<Task> sender) {
+        Task task;
+        while (receiver->Receive(&task)) {
+          sender->Send(std::move(task));
+        }
+      },
+      std::move(ping), pong->MakeSender());
+
+  Task task;
+  while (state.KeepRunning()) {
+    ping_sender->Send(AnimationTask());
+    benchmark::DoNotOptimize(pong->Receive(&task));
+  }
+
+  ping_sender.reset();
+  echo.join();
+}
+BENCHMARK(BenchmarkReceiverPingPong)->UseRealTime();
+
+// Receive a burst of tasks sent from another thread.
+static void BenchmarkReceiverBurst(benchmark::State& state) {
+  const int64_t burst = state.range(0);
+  while (state.KeepRunning()) {
+    auto receiver = MakeReceiver<Task>();
+    auto producer = std::thread(
+        [burst](Sender<Task> sender) {
+          for (int64_t i = 0; i < burst; ++i) {
+            sender->Send(AnimationTask());
+          }
+        },
+        receiver->MakeSender());
+
+    Task task;
+    while (receiver->Receive(&task)) {
+    }
+    producer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BenchmarkReceiverBurst)->Arg(64)->Arg(4096)->UseRealTime();
+
+}  // namespace ftxui
+// NOLINTEND
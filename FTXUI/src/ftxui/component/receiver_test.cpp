@@ -3,6 +3,7 @@
 // the LICENSE file.
 #include <thread>   // for thread
 #include <utility>  // for move
+#include <vector>   // for vector
 
 #include "ftxui/component/receiver.hpp"
 #include "gtest/gtest.h"  // for AssertionResult, Message, Test, TestPartResult, EXPECT_EQ, EXPECT_TRUE, EXPECT_FALSE, TEST
@@ -77,5 +78,57 @@ TEST(Receiver, BasicWithThread) {
   t23.join();
 }
 
+TEST(Receiver, Overflow) {
+  auto receiver = MakeReceiver<int>();
+  auto sender = receiver->MakeSender();
+
+  // More elements than the ring buffer can hold.
+  const int count = 5000;
+  for (int i = 0; i < count; ++i) {
+    sender->Send(i);
+  }
+  sender.reset();
+
+  int value = -1;
+  for (int i = 0; i < count; ++i) {
+    EXPECT_TRUE(receiver->Receive(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(receiver->Receive(&value));
+}
+
+TEST(Receiver, ManyProducers) {
+  auto receiver = MakeReceiver<int>();
+  const int producers = 4;
+  const int count = 10000;
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back(
+        [p](Sender<int> sender) {
+          for (int i = 0; i < count; ++i) {
+            sender->Send(p * count + i);
+          }
+        },
+        receiver->MakeSender());
+  }
+
+  // The elements of every producer are received in order.
+  std::vector<int> next(producers, 0);
+  int value = 0;
+  int received = 0;
+  while (receiver->Receive(&value)) {
+    const int p = value / count;
+    EXPECT_EQ(value % count, next[p]);
+    next[p]++;
+    received++;
+  }
+  EXPECT_EQ(received, producers * count);
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
 }  // namespace ftxui
 // NOLINTEND
@@ -5,6 +5,7 @@
 #include <algorithm>  // for copy, max, min
 #include <array>      // for array
 #include <atomic>
+#include <cerrno>  // for errno, EINTR
 #include <chrono>  // for operator-, milliseconds, operator>=, duration, common_type<>::type, time_point
 #include <csignal>  // for signal, SIGTSTP, SIGABRT, SIGWINCH, raise, SIGFPE, SIGILL, SIGINT, SIGSEGV, SIGTERM, __sighandler_t, size_t
 #include <cstdint>
@@ -15,6 +16,7 @@
 #include <initializer_list>  // for initializer_list
 #include <iostream>  // for cout, ostream, operator<<, basic_ostream, endl, flush
 #include <memory>
+#include <mutex>  // for lock_guard, unique_lock
 #include <stack>  // for stack
 #include <string>
 #include <thread>       // for thread, sleep_for
@@ -47,11 +49,19 @@
 #error Must be compiled in UNICODE mode
 #endif
 #else
+#include <fcntl.h>       // for fcntl, F_GETFL, F_SETFL, O_NONBLOCK
+#include <poll.h>        // for poll, pollfd, POLLOUT
 #include <sys/select.h>  // for select, FD_ISSET, FD_SET, FD_ZERO, fd_set, timeval
 #include <termios.h>  // for tcsetattr, termios, tcgetattr, TCSANOW, cc_t, ECHO, ICANON, VMIN, VTIME
 #include <unistd.h>  // for STDIN_FILENO, read
 #endif
 
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <sys/epoll.h>    // for epoll_create1, epoll_ctl, epoll_wait
+#include <sys/eventfd.h>  // for eventfd
+#include <sys/timerfd.h>  // for timerfd_create, timerfd_settime
+#endif
+
 // Quick exit is missing in standard CLang headers
 #if defined(__clang__) && defined(__APPLE__)
 #define quick_exit(a) exit(a)
@@ -77,6 +87,129 @@ void Flush() {
   std::cout << '\0' << std::flush;
 }
 
+// Write `output`, starting from `*written`, to the terminal. On POSIX systems,
+// this uses a single write(), instead of letting stdio cut it into lines.
+// Unless `blocking`, this stops when the terminal can't accept more, and
+// returns whether everything was written.
+bool WriteFrame(const std::string& output, size_t* written, bool blocking) {
+#if defined(_WIN32) || defined(__EMSCRIPTEN__)
+  std::ignore = blocking;
+  std::cout.write(output.data() + *written,
+                  static_cast<std::streamsize>(output.size() - *written));
+  Flush();
+  *written = output.size();
+  return true;
+#else
+  // Whatever was printed through std::cout must come first.
+  std::cout << std::flush;
+
+  // The flag is shared with every file descriptor of the terminal, so it is
+  // only set for the duration of the write.
+  const int flags = fcntl(STDOUT_FILENO, F_GETFL);
+  const bool set_non_blocking =
+      !blocking && flags >= 0 && (flags & O_NONBLOCK) == 0;
+  if (set_non_blocking) {
+    fcntl(STDOUT_FILENO, F_SETFL, flags | O_NONBLOCK);  // NOLINT
+  }
+
+  while (*written < output.size()) {
+    const ssize_t count = write(STDOUT_FILENO, output.data() + *written,
+                                output.size() - *written);
+    if (count >= 0) {
+      *written += static_cast<size_t>(count);
+      continue;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      *written = output.size();  // The terminal is gone. Drop the output.
+      break;
+    }
+    if (!blocking) {
+      break;
+    }
+    pollfd fd = {STDOUT_FILENO, POLLOUT, 0};
+    poll(&fd, 1, -1);
+  }
+
+  if (set_non_blocking) {
+    fcntl(STDOUT_FILENO, F_SETFL, flags);  // NOLINT
+  }
+  return *written == output.size();
+#endif
+}
+
+std::atomic<int> g_signal_exit_count = 0;  // NOLINT
+#if !defined(_WIN32)
+std::atomic<int> g_signal_stop_count = 0;    // NOLINT
+std::atomic<int> g_signal_resize_count = 0;  // NOLINT
+
+// The terminal size, packed into a single atomic so that both dimensions are
+// always read together. It is queried again only after SIGWINCH marked it
+// stale, instead of doing an ioctl every frame. A known size has its top bit
+// set, so that no size, even {0, 0}, is mistaken for the other states.
+constexpr uint64_t kTerminalSizeStale = 0;
+constexpr uint64_t kTerminalSizeQuerying = 1;
+constexpr uint64_t kTerminalSizeKnown = uint64_t(1) << 63U;
+std::atomic<uint64_t> g_terminal_size = kTerminalSizeStale;  // NOLINT
+#endif
+
+Dimensions TerminalSize() {
+#if defined(_WIN32)
+  // There is no resize signal to invalidate a cached value.
+  return Terminal::Size();
+#else
+  uint64_t size = g_terminal_size;
+  if (size == kTerminalSizeQuerying) {
+    return Terminal::Size();
+  }
+  while (size == kTerminalSizeStale) {
+    g_terminal_size = kTerminalSizeQuerying;
+    const Dimensions dimensions = Terminal::Size();
+    size = kTerminalSizeKnown |
+           uint64_t(uint32_t(std::max(dimensions.dimx, 0))) << 32U |  // NOLINT
+           uint32_t(dimensions.dimy);
+    // A resize recorded during the query marks the result stale again.
+    uint64_t expected = kTerminalSizeQuerying;
+    if (!g_terminal_size.compare_exchange_strong(expected, size)) {
+      size = kTerminalSizeStale;
+    }
+  }
+  return {int((size & ~kTerminalSizeKnown) >> 32U),  // NOLINT
+          int(size & 0xFFFFFFFFU)};                  // NOLINT
+#endif
+}
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+// An eventfd waking up the event listener, to quit or to forward a signal.
+std::atomic<int> g_event_listener_wakeup_fd = -1;  // NOLINT
+
+// Async signal safe function
+void WakeUpEventListener() {
+  const int fd = g_event_listener_wakeup_fd;
+  if (fd >= 0) {
+    const uint64_t one = 1;
+    std::ignore = write(fd, &one, sizeof(one));
+  }
+}
+#else
+// The event listener wakes up periodically on its own.
+void WakeUpEventListener() {}
+#endif
+
+// The main loop sleeps while there are no tasks. Wake it up, so that it
+// executes the handlers of the signals recorded meanwhile.
+void WakeUpOnSignal(const Sender<Task>& out) {
+  bool pending = g_signal_exit_count != 0;
+#if !defined(_WIN32)
+  pending |= g_signal_stop_count != 0 || g_signal_resize_count != 0;
+#endif
+  if (pending) {
+    out->Send(Closure([] {}));
+  }
+}
+
 constexpr int timeout_milliseconds = 20;
 [[maybe_unused]] constexpr int timeout_microseconds =
     timeout_milliseconds * 1000;
@@ -92,6 +225,7 @@ void EventListener(std::atomic<bool>* quit, Sender<Task> out) {
     auto wait_result = WaitForSingleObject(console, timeout_milliseconds);
     if (wait_result == WAIT_TIMEOUT) {
       parser.Timeout(timeout_milliseconds);
+      WakeUpOnSignal(out);
       continue;
     }
 
@@ -148,6 +282,7 @@ void EventListener(std::atomic<bool>* quit, Sender<Task> out) {
 
     emscripten_sleep(1);
     parser.Timeout(1);
+    WakeUpOnSignal(out);
   }
 }
 
@@ -162,7 +297,7 @@ void ftxui_on_resize(int columns, int rows) {
 }
 }
 
-#else  // POSIX (Linux & Mac)
+#else  // POSIX
 
 int CheckStdinReady(int usec_timeout) {
   timeval tv = {0, usec_timeout};  // NOLINT
@@ -173,25 +308,142 @@ int CheckStdinReady(int usec_timeout) {
   return FD_ISSET(STDIN_FILENO, &fds);                    // NOLINT
 }
 
-// Read char from the terminal.
-void EventListener(std::atomic<bool>* quit, Sender<Task> out) {
+// Read char from the terminal, waking up periodically to time out escape
+// sequences and to notice the signals.
+void PollEventListener(std::atomic<bool>* quit, const Sender<Task>& out) {
   auto parser =
       TerminalInputParser([&](Event event) { out->Send(std::move(event)); });
 
+  // At the end of a regular file, select() keeps reporting stdin ready.
+  bool end_of_input = false;
   while (!*quit) {
-    if (!CheckStdinReady(timeout_microseconds)) {
+    if (end_of_input) {
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(timeout_milliseconds));
+    }
+    if (end_of_input || !CheckStdinReady(timeout_microseconds)) {
       parser.Timeout(timeout_milliseconds);
+      WakeUpOnSignal(out);
       continue;
     }
 
     const size_t buffer_size = 100;
     std::array<char, buffer_size> buffer;                        // NOLINT;
-    size_t l = read(fileno(stdin), buffer.data(), buffer_size);  // NOLINT
-    for (size_t i = 0; i < l; ++i) {
+    // Negative on error, like EAGAIN while a frame is written.
+    const ssize_t l = read(fileno(stdin), buffer.data(), buffer_size);
+    end_of_input = l == 0;
+    for (ssize_t i = 0; i < l; ++i) {
       parser.Add(buffer[i]);  // NOLINT
     }
   }
 }
+
+#if defined(__linux__)
+
+// Arm `timer_fd` to expire once after `milliseconds`. Zero disarms it.
+void ArmTimer(int timer_fd, int milliseconds) {
+  itimerspec spec = {};
+  spec.it_value.tv_sec = milliseconds / 1000;               // NOLINT
+  spec.it_value.tv_nsec = (milliseconds % 1000) * 1000000;  // NOLINT
+  timerfd_settime(timer_fd, 0, &spec, nullptr);
+}
+
+// Read char from the terminal. Sleep until there is input, a wakeup, or an
+// escape sequence to time out.
+void EventListener(std::atomic<bool>* quit, Sender<Task> out) {
+  auto parser =
+      TerminalInputParser([&](Event event) { out->Send(std::move(event)); });
+
+  const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  const int wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  const int timer_fd =
+      timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  bool watched = epoll_fd >= 0 && wakeup_fd >= 0 && timer_fd >= 0;
+  for (const int fd : {STDIN_FILENO, wakeup_fd, timer_fd}) {
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    watched = watched && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+  }
+  // epoll can't watch a stdin redirected from a regular file: poll it
+  // instead.
+  if (!watched) {
+    for (const int fd : {timer_fd, wakeup_fd, epoll_fd}) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+    PollEventListener(quit, out);
+    return;
+  }
+  g_event_listener_wakeup_fd = wakeup_fd;
+
+  // A parser waiting for the end of an escape sequence is flushed after this
+  // delay.
+  const int escape_timeout_milliseconds = 50;
+  bool timer_armed = false;
+
+  const size_t buffer_size = 4096;
+  std::array<char, buffer_size> buffer;  // NOLINT
+  while (!*quit) {
+    WakeUpOnSignal(out);
+
+    bool received_input = false;
+    std::array<epoll_event, 3> events;  // NOLINT
+    const int count = epoll_wait(epoll_fd, events.data(),
+                                 static_cast<int>(events.size()), -1);
+    for (int i = 0; i < count; ++i) {
+      const int fd = events[i].data.fd;  // NOLINT
+
+      if (fd == STDIN_FILENO) {
+        const ssize_t l = read(STDIN_FILENO, buffer.data(), buffer_size);
+        // The terminal is non-blocking while a frame is written.
+        if (l < 0 && (errno == EAGAIN || errno == EINTR)) {
+          continue;
+        }
+        // Stop watching a closed stdin, instead of waking up forever.
+        if (l <= 0) {
+          epoll_ctl(epoll_fd, EPOLL_CTL_DEL, STDIN_FILENO, nullptr);
+          continue;
+        }
+        for (ssize_t j = 0; j < l; ++j) {
+          parser.Add(buffer[j]);  // NOLINT
+        }
+        received_input = true;
+        continue;
+      }
+
+      uint64_t value = 0;
+      std::ignore = read(fd, &value, sizeof(value));
+      if (fd == timer_fd) {
+        timer_armed = false;
+        parser.Timeout(escape_timeout_milliseconds);
+      }
+    }
+
+    // The timeout counts from the latest input.
+    const bool pending = parser.HasPending();
+    if (pending && (received_input || !timer_armed)) {
+      ArmTimer(timer_fd, escape_timeout_milliseconds);
+    } else if (!pending && timer_armed) {
+      ArmTimer(timer_fd, 0);
+    }
+    timer_armed = pending;
+  }
+
+  g_event_listener_wakeup_fd = -1;
+  close(timer_fd);
+  close(wakeup_fd);
+  close(epoll_fd);
+}
+
+#else  // Mac
+
+void EventListener(std::atomic<bool>* quit, Sender<Task> out) {
+  PollEventListener(quit, out);
+}
+
+#endif
 #endif
 
 std::stack<Closure> on_exit_functions;  // NOLINT
@@ -202,12 +454,6 @@ void OnExit() {
   }
 }
 
-std::atomic<int> g_signal_exit_count = 0;  // NOLINT
-#if !defined(_WIN32)
-std::atomic<int> g_signal_stop_count = 0;    // NOLINT
-std::atomic<int> g_signal_resize_count = 0;  // NOLINT
-#endif
-
 // Async signal safe function
 void RecordSignal(int signal) {
   switch (signal) {
@@ -226,13 +472,15 @@ void RecordSignal(int signal) {
       break;
 
     case SIGWINCH:  // NOLINT
+      g_terminal_size = kTerminalSizeStale;
       g_signal_resize_count++;
       break;
 #endif
 
     default:
-      break;
+      return;
   }
+  WakeUpEventListener();
 }
 
 void ExecuteSignalHandlers() {
@@ -272,6 +520,14 @@ const std::string ST = "\x1b\\";  // NOLINT
 // DECSCUSR: Set Cursor Style
 const std::string DECRQSS_DECSCUSR = DCS + "$q q" + ST;  // NOLINT
 
+// DECRQM: Request Mode. The terminal replies with a DECRPM.
+// Mode 2026: Synchronized Update. See
+// https://gist.github.com/christianparpart/d8a62cc1ab659194337d73e399004036
+const std::string DECRQM_SYNCHRONIZED_UPDATE = CSI + "?2026$p";  // NOLINT
+const int kSynchronizedUpdateMode = 2026;
+const std::string kBeginSynchronizedUpdate = CSI + "?2026h";  // NOLINT
+const std::string kEndSynchronizedUpdate = CSI + "?2026l";    // NOLINT
+
 // DEC: Digital Equipment Corporation
 enum class DECMode : std::uint16_t {
   kLineWrap = 7,
@@ -289,6 +545,7 @@ enum class DECMode : std::uint16_t {
   kMouseUrxvtMode = 1015,
   kMouseSgrPixelsMode = 1016,
   kAlternateScreen = 1049,
+  kBracketedPaste = 2004,
 };
 
 // Device Status Report (DSR) {
@@ -338,15 +595,6 @@ class CapturedMouseImpl : public CapturedMouseInterface {
   std::function<void(void)> callback_;
 };
 
-void AnimationListener(std::atomic<bool>* quit, Sender<Task> out) {
-  // Animation at around 60fps.
-  const auto time_delta = std::chrono::milliseconds(15);
-  while (!*quit) {
-    out->Send(AnimationTask());
-    std::this_thread::sleep_for(time_delta);
-  }
-}
-
 }  // namespace
 
 ScreenInteractive::ScreenInteractive(Dimension dimension,
@@ -449,6 +697,54 @@ void ScreenInteractive::TrackMouse(bool enable) {
   track_mouse_ = enable;
 }
 
+/// @brief Set whether pasted text is delivered as a single Event::Paste,
+/// instead of one event per character. This is disabled by default.
+/// Must be called before Loop().
+/// @param enable Whether to enable bracketed paste.
+///
+/// ### Example
+///
+/// ```cpp
+/// auto screen = ScreenInteractive::Fullscreen();
+/// screen.TrackPaste();
+/// screen.Loop(component);
+/// ```
+void ScreenInteractive::TrackPaste(bool enable) {
+  track_paste_ = enable;
+}
+
+/// @brief Reduce the amount of output, for slow remote links.
+/// Every style change is printed as a single, shortest, SGR sequence, and the
+/// terminal is asked for the cursor position only after a resize. Limiting the
+/// colors is left to Terminal::SetColorSupport(), which must be called before
+/// any color is created.
+/// Must be called before Loop().
+/// @param enable Whether to reduce the output.
+void ScreenInteractive::SetLowBandwidth(bool enable) {
+  low_bandwidth_ = enable;
+  SetCompactStyle(enable);
+}
+
+/// @brief Limit the number of frames drawn per second.
+/// The tasks received in between two frames, like a burst of key repeats, are
+/// all handled before drawing the next one. This reduces the amount of output
+/// sent to slow terminals.
+/// @param fps The maximum number of frames per second. 0 means unlimited,
+/// which is the default.
+///
+/// ### Example
+///
+/// ```cpp
+/// auto screen = ScreenInteractive::Fullscreen();
+/// screen.SetMaxFPS(60);
+/// screen.Loop(component);
+/// ```
+void ScreenInteractive::SetMaxFPS(int fps) {
+  min_frame_interval_ = fps > 0 ? animation::Clock::duration(
+                                      std::chrono::seconds(1)) / fps
+                                : animation::Clock::duration(0);
+}
+
 /// @brief Add a task to the main loop.
 /// It will be executed later, after every other scheduled tasks.
 void ScreenInteractive::Post(Task task) {
@@ -479,6 +775,12 @@ void ScreenInteractive::RequestAnimationFrame() {
   if (now - previous_animation_time_ >= time_histeresis) {
     previous_animation_time_ = now;
   }
+
+  {
+    const std::lock_guard<std::mutex> lock(animation_mutex_);
+    animation_pending_ = true;
+  }
+  animation_notifier_.notify_one();
 }
 
 /// @brief Try to get the unique lock about behing able to capture the mouse.
@@ -601,6 +903,9 @@ ScreenInteractive* ScreenInteractive::Active() {
 void ScreenInteractive::Install() {
   frame_valid_ = false;
 
+  // The terminal content is unknown, the next frame must be fully printed.
+  previous_frame_ = Screen(0, 0);
+
   // Flush the buffer for stdout to ensure whatever the user has printed before
   // is fully applied before we start modifying the terminal configuration. This
   // is important, because we are using two different channels (stdout vs
@@ -617,6 +922,12 @@ void ScreenInteractive::Install() {
   // Request the terminal to report the current cursor shape. We will restore it
   // on exit.
   std::cout << DECRQSS_DECSCUSR;
+
+  // Request whether the terminal supports synchronized updates. Until it
+  // replies, frames are printed without.
+  synchronized_update_ = false;
+  std::cout << DECRQM_SYNCHRONIZED_UPDATE;
+
   on_exit_functions.emplace([this] {
     std::cout << "\033[?25h";  // Enable cursor.
     std::cout << "\033[" + std::to_string(cursor_reset_shape_) + " q";
@@ -663,6 +974,8 @@ void ScreenInteractive::Install() {
   for (const int signal : {SIGWINCH, SIGTSTP}) {
     InstallSignalHandler(signal);
   }
+  // The terminal may have been resized while no handler was installed.
+  g_terminal_size = kTerminalSizeStale;
 
   struct termios terminal;  // NOLINT
   tcgetattr(STDIN_FILENO, &terminal);
@@ -727,6 +1040,14 @@ void ScreenInteractive::Install() {
     enable({DECMode::kMouseSgrExtMode});
   }
 
+  if (track_paste_) {
+    enable({DECMode::kBracketedPaste});
+  }
+
+  // The end of the last frame must reach the terminal before the configuration
+  // is restored.
+  on_exit_functions.emplace([this] { WriteOutput(/*blocking=*/true); });
+
   // After installing the new configuration, flush it to the terminal to
   // ensure it is fully applied:
   Flush();
@@ -736,7 +1057,8 @@ void ScreenInteractive::Install() {
   event_listener_ =
       std::thread(&EventListener, &quit_, task_receiver_->MakeSender());
   animation_listener_ =
-      std::thread(&AnimationListener, &quit_, task_receiver_->MakeSender());
+      std::thread(&ScreenInteractive::AnimationListener, this,
+                  task_receiver_->MakeSender());
 }
 
 // private
@@ -751,10 +1073,28 @@ void ScreenInteractive::Uninstall() {
 // NOLINTNEXTLINE
 void ScreenInteractive::RunOnceBlocking(Component component) {
   ExecuteSignalHandlers();
+
+  // Draw the invalidated frame, if any, before waiting for the next task.
+  if (!frame_valid_) {
+    RunOnce(component);
+    ExecuteSignalHandlers();
+  }
+
   Task task;
   if (task_receiver_->Receive(&task)) {
     HandleTask(component, task);
   }
+
+  // Coalesce the bursts of tasks, like key repeats, into a single frame.
+  if (!frame_valid_ && min_frame_interval_.count() > 0) {
+    const animation::TimePoint deadline =
+        previous_frame_time_ + min_frame_interval_;
+    while (animation::Clock::now() < deadline &&
+           task_receiver_->ReceiveUntil(&task, deadline)) {
+      HandleTask(component, task);
+      ExecuteSignalHandlers();
+    }
+  }
   RunOnce(component);
 }
 
@@ -797,6 +1137,15 @@ void ScreenInteractive::HandleTask(Component component, Task& task) {
         return;
       }
 
+      if (arg.is_mode_report()) {
+        // 1: set, 2: reset. 0: unknown mode, 3-4: permanently set/reset.
+        if (arg.mode_report_mode() == kSynchronizedUpdateMode) {
+          synchronized_update_ =
+              arg.mode_report_value() == 1 || arg.mode_report_value() == 2;
+        }
+        return;
+      }
+
       if (arg.is_mouse()) {
         arg.mouse().x -= cursor_x_;
         arg.mouse().y -= cursor_y_;
@@ -908,10 +1257,20 @@ void ScreenInteractive::Draw(Component component) {
   if (frame_valid_) {
     return;
   }
+
+  // The terminal is still busy with the previous frame. Skip this one: the
+  // latest state is drawn once it is drained. Retry on the next animation
+  // frame.
+  if (!WriteOutput(/*blocking=*/false)) {
+    congested_ = true;
+    RequestAnimationFrame();
+    return;
+  }
+
   auto document = component->Render();
   int dimx = 0;
   int dimy = 0;
-  auto terminal = Terminal::Size();
+  auto terminal = TerminalSize();
   document->ComputeRequirement();
   switch (dimension_) {
     case Dimension::Fixed:
@@ -933,21 +1292,30 @@ void ScreenInteractive::Draw(Component component) {
   }
 
   const bool resized = frame_count_ == 0 || (dimx != dimx_) || (dimy != dimy_);
-  ResetCursorPosition();
-  std::cout << ResetPosition(/*clear=*/resized);
+
+  // The whole frame is built into a single buffer, and written at once.
+  output_buffer_.clear();
+  output_written_ = 0;
+  if (synchronized_update_) {
+    output_buffer_ += kBeginSynchronizedUpdate;
+  }
+  output_buffer_ += reset_cursor_position;
+  reset_cursor_position.clear();
+  output_buffer_ += ResetPosition(/*clear=*/resized);
 
   // If the terminal width decrease, the terminal emulator will start wrapping
   // lines and make the display dirty. We should clear it completely.
   if ((dimx < dimx_) && !use_alternative_screen_) {
-    std::cout << "\033[J";  // clear terminal output
-    std::cout << "\033[H";  // move cursor to home position
+    output_buffer_ += "\033[J";  // clear terminal output
+    output_buffer_ += "\033[H";  // move cursor to home position
   }
 
   // Resize the screen if needed.
   if (resized) {
     dimx_ = dimx;
     dimy_ = dimy;
-    pixels_ = std::vector<std::vector<Pixel>>(dimy, std::vector<Pixel>(dimx));
+    pixels_.assign(static_cast<size_t>(dimx) * static_cast<size_t>(dimy),
+                   Pixel());
     cursor_.x = dimx_ - 1;
     cursor_.y = dimy_ - 1;
   }
@@ -962,17 +1330,17 @@ void ScreenInteractive::Draw(Component component) {
   // component. See [issue]. Solution is to request cursor position less
   // often. [bug]: https://github.com/microsoft/terminal/pull/7583 [issue]:
   // https://github.com/ArthurSonzogni/FTXUI/issues/136
-  static int i = -3;
-  ++i;
-  if (!use_alternative_screen_ && (i % 150 == 0)) {  // NOLINT
-    std::cout << DeviceStatusReport(DSRMode::kCursor);
+  const int i = ++dsr_counter_;
+  if (!use_alternative_screen_ && !low_bandwidth_ &&
+      (i % 150 == 0)) {  // NOLINT
+    output_buffer_ += DeviceStatusReport(DSRMode::kCursor);
   }
 #else
-  static int i = -3;
-  ++i;
+  const int i = ++dsr_counter_;
   if (!use_alternative_screen_ &&
-      (previous_frame_resized_ || i % 40 == 0)) {  // NOLINT
-    std::cout << DeviceStatusReport(DSRMode::kCursor);
+      (previous_frame_resized_ ||
+       (!low_bandwidth_ && i % 40 == 0))) {  // NOLINT
+    output_buffer_ += DeviceStatusReport(DSRMode::kCursor);
   }
 #endif
   previous_frame_resized_ = resized;
@@ -1011,11 +1379,40 @@ void ScreenInteractive::Draw(Component component) {
     }
   }
 
-  std::cout << ToString() << set_cursor_position;
-  Flush();
+  // Only print the cells that changed since the previous frame, unless the
+  // terminal was cleared above.
+  if (resized) {
+    ToString(output_buffer_);
+  } else {
+    // Scroll regions are relative to the top of the terminal, where only a
+    // fullscreen alternate screen is known to be.
+    const bool scroll_region =
+        use_alternative_screen_ && dimension_ == Dimension::Fullscreen;
+    ToDiffString(previous_frame_, output_buffer_, scroll_region);
+  }
+  output_buffer_ += set_cursor_position;
+  if (synchronized_update_) {
+    output_buffer_ += kEndSynchronizedUpdate;
+  }
+  last_frame_size_ = output_buffer_.size();
+  // Draw another frame once the congestion ends, so it doesn't stay
+  // reported.
+  const bool was_congested = congested_;
+  congested_ = !WriteOutput(/*blocking=*/false);
+  if (congested_ || was_congested) {
+    RequestAnimationFrame();
+  }
+  previous_frame_ = *this;
   Clear();
   frame_valid_ = true;
   frame_count_++;
+  previous_frame_time_ = animation::Clock::now();
+}
+
+// private
+// Write the remaining part of the frame. Return whether it was fully written.
+bool ScreenInteractive::WriteOutput(bool blocking) {
+  return WriteFrame(output_buffer_, &output_written_, blocking);
 }
 
 // private
@@ -1036,10 +1433,35 @@ void ScreenInteractive::Exit() {
 
 // private:
 void ScreenInteractive::ExitNow() {
-  quit_ = true;
+  {
+    const std::lock_guard<std::mutex> lock(animation_mutex_);
+    quit_ = true;
+  }
+  animation_notifier_.notify_one();
+  WakeUpEventListener();
   task_sender_.reset();
 }
 
+// private:
+// Send an animation tick, at around 60fps, for every requested frame. In
+// between, sleep until one is requested.
+void ScreenInteractive::AnimationListener(Sender<Task> out) {
+  const auto time_delta = std::chrono::milliseconds(15);
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(animation_mutex_);
+      animation_notifier_.wait(lock,
+                               [&] { return animation_pending_ || quit_; });
+      if (quit_) {
+        return;
+      }
+      animation_pending_ = false;
+    }
+    std::this_thread::sleep_for(time_delta);
+    out->Send(AnimationTask());
+  }
+}
+
 // private:
 void ScreenInteractive::Signal(int signal) {
   if (signal == SIGABRT) {
@@ -1051,6 +1473,7 @@ void ScreenInteractive::Signal(int signal) {
 #if !defined(_WIN32)
   if (signal == SIGTSTP) {
     Post([&] {
+      WriteOutput(/*blocking=*/true);
       ResetCursorPosition();
       std::cout << ResetPosition(/*clear*/ true);  // Cursor to the beginning
       Uninstall();
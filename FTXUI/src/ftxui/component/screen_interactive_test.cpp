@@ -2,11 +2,14 @@
 // Use of this source code is governed by the MIT license that can be found in
 // the LICENSE file.
 #include <gtest/gtest.h>  // for Test, TestInfo (ptr only), TEST, EXPECT_EQ, Message, TestPartResult
+#include <chrono>  // for milliseconds
 #include <csignal>  // for raise, SIGABRT, SIGFPE, SIGILL, SIGINT, SIGSEGV, SIGTERM
 #include <ftxui/component/event.hpp>  // for Event, Event::Custom
+#include <thread>                     // for thread, sleep_for
 #include <tuple>                      // for _Swallow_assign, ignore
 
 #include "ftxui/component/component.hpp"  // for Renderer
+#include "ftxui/component/loop.hpp"       // for Loop
 #include "ftxui/component/screen_interactive.hpp"
 #include "ftxui/dom/elements.hpp"  // for text, Element
 
@@ -15,8 +18,8 @@
 #include <unistd.h>
 #include <array>
 #include <cstdio>
-#include <ftxui/component/loop.hpp>
 #include <string>
+#include "ftxui/screen/terminal.hpp"
 #endif
 
 namespace ftxui {
@@ -77,6 +80,43 @@ bool TestSignal(int signal) {
   EXPECT_EQ(called, 2);
   return true;
 }
+
+// The number of frames drawn for a burst of key repeats, arriving one by one
+// while the loop is waiting for them.
+int RenderCountForBurst(int max_fps) {
+  auto screen = ScreenInteractive::FitComponent();
+  screen.SetMaxFPS(max_fps);
+
+  int render_count = 0;
+  int event_count = 0;
+  auto component = Renderer([&] {
+    ++render_count;
+    return text("");
+  });
+  component |= CatchEvent([&](Event event) {
+    event_count += (event == Event::Character('a'));
+    return false;
+  });
+
+  Loop loop(&screen, component);
+  loop.RunOnce();
+  EXPECT_EQ(render_count, 1);
+
+  const int burst = 20;
+  std::thread typist([&] {
+    for (int i = 0; i < burst; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      screen.PostEvent(Event::Character('a'));
+    }
+  });
+  while (event_count < burst) {
+    loop.RunOnceBlocking();
+  }
+  typist.join();
+
+  EXPECT_EQ(event_count, burst);
+  return render_count - 1;
+}
 }  // namespace
 
 TEST(ScreenInteractive, Signal_SIGTERM) {
@@ -179,6 +219,156 @@ TEST(ScreenInteractive, CtrlC_NotForced) {
   ASSERT_GE(ctrl_c_count, 50);
 }
 
+// The burst takes about 40ms: within a single frame at 5 FPS.
+TEST(ScreenInteractive, MaxFPSCoalesceEvents) {
+  EXPECT_EQ(RenderCountForBurst(5), 1);
+}
+
+TEST(ScreenInteractive, NoMaxFPSRendersEachEvent) {
+  EXPECT_GT(RenderCountForBurst(0), 1);
+}
+
+// The terminal size is queried again only after a SIGWINCH.
+TEST(ScreenInteractive, TerminalSizeCachedUntilResize) {
+#if defined(__unix__)
+  std::string output;
+  {
+    auto capture = StdCapture(&output);
+    Terminal::SetFallbackSize({10, 2});
+    auto screen = ScreenInteractive::TerminalOutput();
+    auto component = Renderer([] { return text(""); });
+
+    Loop loop(&screen, component);
+    loop.RunOnce();
+    EXPECT_EQ(screen.dimx(), 10);
+
+    // Not noticed, as long as no resize is signaled.
+    Terminal::SetFallbackSize({20, 2});
+    screen.PostEvent(Event::Custom);
+    loop.RunOnce();
+    EXPECT_EQ(screen.dimx(), 10);
+
+    std::ignore = std::raise(SIGWINCH);
+    screen.Post([] {});  // Run the signal handlers.
+    loop.RunOnce();
+    EXPECT_EQ(screen.dimx(), 20);
+
+    Terminal::SetFallbackSize({80, 24});
+  }
+#endif
+}
+
+// An empty terminal size is cached like any other.
+TEST(ScreenInteractive, TerminalSizeEmpty) {
+#if defined(__unix__)
+  std::string output;
+  {
+    auto capture = StdCapture(&output);
+    Terminal::SetFallbackSize({0, 0});
+    std::ignore = std::raise(SIGWINCH);
+    auto screen = ScreenInteractive::TerminalOutput();
+    auto component = Renderer([] { return text(""); });
+
+    Loop loop(&screen, component);
+    loop.RunOnce();
+    screen.PostEvent(Event::Custom);
+    loop.RunOnce();
+    EXPECT_EQ(screen.dimx(), 0);
+
+    Terminal::SetFallbackSize({80, 24});
+    std::ignore = std::raise(SIGWINCH);
+    screen.Post([] {});  // Run the signal handlers.
+    loop.RunOnce();
+  }
+#endif
+}
+
+// Frames are wrapped into synchronized update markers, once the terminal
+// reported supporting them.
+TEST(ScreenInteractive, SynchronizedUpdate) {
+#if defined(__unix__)
+  std::string output;
+  {
+    auto capture = StdCapture(&output);
+
+    auto screen = ScreenInteractive::FixedSize(2, 1);
+    auto component = Renderer([&] { return text("AB"); });
+
+    Loop loop(&screen, component);
+    loop.RunOnce();
+    screen.PostEvent(Event::ModeReport("\x1B[?2026;2$y", 2026, 2));
+    screen.PostEvent(Event::Custom);
+    loop.RunOnce();
+  }
+  const auto begin = output.find("\x1B[?2026h");
+  const auto end = output.find("\x1B[?2026l");
+  ASSERT_NE(begin, std::string::npos);
+  ASSERT_NE(end, std::string::npos);
+  EXPECT_LT(begin, end);
+  // The first frame, printed before the reply, isn't wrapped.
+  EXPECT_LT(output.find("AB"), begin);
+#endif
+}
+
+// When the terminal doesn't drain the output, the frames in between are
+// skipped, and only the latest one is printed.
+TEST(ScreenInteractive, CongestedOutputSkipsFrames) {
+#if defined(__unix__)
+  int pipefd[2];
+  ASSERT_EQ(pipe(pipefd), 0);
+  fcntl(pipefd[0], F_SETFL, O_NONBLOCK);
+  fflush(stdout);
+  const int old_stdout = dup(fileno(stdout));
+  dup2(pipefd[1], fileno(stdout));
+  close(pipefd[1]);
+
+  std::string output;
+  auto drain = [&] {
+    std::array<char, 4096> buffer;
+    ssize_t count = 0;
+    while ((count = read(pipefd[0], buffer.data(), buffer.size())) > 0) {
+      output.append(buffer.data(), count);
+    }
+  };
+
+  int render_count = 0;
+  {
+    // A first frame larger than the pipe capacity.
+    auto screen = ScreenInteractive::FixedSize(400, 400);
+    auto component = Renderer([&] {
+      render_count++;
+      return text(std::to_string(render_count));
+    });
+
+    Loop loop(&screen, component);
+    loop.RunOnce();
+    EXPECT_TRUE(screen.IsCongested());
+
+    for (int i = 0; i < 3; ++i) {
+      screen.PostEvent(Event::Custom);
+      loop.RunOnce();
+    }
+    EXPECT_EQ(render_count, 1);
+
+    while (screen.IsCongested()) {
+      drain();
+      screen.PostEvent(Event::Custom);
+      loop.RunOnce();
+    }
+    EXPECT_EQ(render_count, 2);
+    drain();
+  }
+  drain();
+  fflush(stdout);
+  dup2(old_stdout, fileno(stdout));
+  close(old_stdout);
+  close(pipefd[0]);
+
+  // The first frame isn't cut.
+  EXPECT_GT(output.size(), 400 * 400);
+#endif
+}
+
 // Regression test for:
 // https://github.com/ArthurSonzogni/FTXUI/pull/1064/files
 TEST(ScreenInteractive, FixedSizeInitialFrame) {
@@ -200,6 +390,7 @@ TEST(ScreenInteractive, FixedSizeInitialFrame) {
       "\0"           // Flush stdout.
       "\x1BP$q q"    // Set cursor shape to 1 (block).
       "\x1B\\"       // Reset cursor position.
+      "\x1B[?2026$p"  // Request synchronized update support.
       "\x1B[?7l"     // Disable line wrapping.
       "\x1B[?1000h"  // Enable mouse tracking.
       "\x1B[?1003h"  // Enable mouse motion tracking.
@@ -221,9 +412,6 @@ TEST(ScreenInteractive, FixedSizeInitialFrame) {
       "\x1B[1D"    // Move cursor left one character.
       "\x1B[?25l"  // Hide cursor.
 
-      // Flush
-      "\0"  // Flush stdout.
-
       // Uninstall the ScreenInteractive.
       "\x1B[1C"      // Move cursor right one character.
       "\x1B[?1006l"  // Disable SGR mouse tracking.
@@ -8,6 +8,7 @@
 #include <functional>                 // for std::function
 #include <map>
 #include <memory>   // for unique_ptr, allocator
+#include <string_view>  // for string_view
 #include <utility>  // for move
 #include <vector>
 #include "ftxui/component/event.hpp"  // for Event
@@ -95,6 +96,19 @@ TerminalInputParser::TerminalInputParser(std::function<void(Event)> out)
 
 void TerminalInputParser::Timeout(int time) {
   timeout_ += time;
+
+  // The end marker of the paste was lost: deliver what was received, and
+  // read the next input as keys again.
+  if (pasting_) {
+    const int paste_timeout_threshold = 500;
+    if (timeout_ >= paste_timeout_threshold) {
+      timeout_ = 0;
+      pasting_ = false;
+      SendPaste();
+    }
+    return;
+  }
+
   const int timeout_threshold = 50;
   if (timeout_ < timeout_threshold) {
     return;
@@ -106,12 +120,52 @@ void TerminalInputParser::Timeout(int time) {
 }
 
 void TerminalInputParser::Add(char c) {
+  if (pasting_) {
+    AddPaste(c);
+    return;
+  }
   pending_ += c;
   timeout_ = 0;
   position_ = -1;
   Send(Parse());
 }
 
+void TerminalInputParser::AddPaste(char c) {
+  // Terminals send the pasted new lines as the return key, or pass CRLF
+  // through: both are a single new line.
+  timeout_ = 0;
+  const bool after_cr = paste_after_cr_;
+  paste_after_cr_ = (c == '\r');
+  if (c == '\n' && after_cr) {
+    return;
+  }
+  paste_ += (c == '\r') ? '\n' : c;
+
+  constexpr std::string_view end = "\x1B[201~";
+  if (paste_.size() >= end.size() &&
+      std::string_view(paste_).substr(paste_.size() - end.size()) == end) {
+    paste_.resize(paste_.size() - end.size());
+    pasting_ = false;
+    SendPaste();
+    return;
+  }
+
+  // Larger pastes are delivered in several events. The bytes that may be
+  // the start of the end marker are kept.
+  const size_t max_paste_size = 1 << 20;
+  if (paste_.size() >= max_paste_size) {
+    std::string rest = paste_.substr(paste_.size() - (end.size() - 1));
+    paste_.resize(paste_.size() - rest.size());
+    SendPaste();
+    paste_ = std::move(rest);
+  }
+}
+
+void TerminalInputParser::SendPaste() {
+  out_(Event::Paste(std::move(paste_)));
+  paste_.clear();
+}
+
 unsigned char TerminalInputParser::Current() {
   return pending_[position_];
 }
@@ -136,6 +190,12 @@ void TerminalInputParser::Send(TerminalInputParser::Output output) {
       return;
 
     case SPECIAL: {
+      if (pending_ == "\x1B[200~") {
+        pasting_ = true;
+        paste_after_cr_ = false;
+        pending_.clear();
+        return;
+      }
       auto it = g_uniformize.find(pending_);
       if (it != g_uniformize.end()) {
         pending_ = it->second;
@@ -161,6 +221,13 @@ void TerminalInputParser::Send(TerminalInputParser::Output output) {
       out_(Event::CursorShape(std::move(pending_), output.cursor_shape));
       pending_.clear();
       return;
+
+    case MODE_REPORT:
+      out_(Event::ModeReport(std::move(pending_),
+                             output.mode_report.mode,     // NOLINT
+                             output.mode_report.value));  // NOLINT
+      pending_.clear();
+      return;
   }
   // NOT_REACHED().
 }
@@ -374,6 +441,12 @@ TerminalInputParser::Output TerminalInputParser::ParseCSI() {
           return ParseMouse(altered, false, std::move(arguments));
         case 'R':
           return ParseCursorPosition(std::move(arguments));
+        case 'y':
+          // DECRPM: CSI ? mode ; value $ y
+          if (pending_[2] == '?' && pending_[pending_.size() - 2] == '$') {
+            return ParseModeReport(std::move(arguments));
+          }
+          return SPECIAL;
         default:
           return SPECIAL;
       }
@@ -461,4 +534,15 @@ TerminalInputParser::Output TerminalInputParser::ParseCursorPosition(
   return output;
 }
 
+TerminalInputParser::Output TerminalInputParser::ParseModeReport(
+    std::vector<int> arguments) {
+  if (arguments.size() != 2) {
+    return SPECIAL;
+  }
+  Output output(MODE_REPORT);
+  output.mode_report.mode = arguments[0];   // NOLINT
+  output.mode_report.value = arguments[1];  // NOLINT
+  return output;
+}
+
 }  // namespace ftxui
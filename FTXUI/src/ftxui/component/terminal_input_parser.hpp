@@ -20,9 +20,15 @@ class TerminalInputParser {
   void Timeout(int time);
   void Add(char c);
 
+  // Whether an uncompleted sequence or paste is waiting for more input, or
+  // for a timeout.
+  bool HasPending() const { return !pending_.empty() || pasting_; }
+
  private:
   unsigned char Current();
   bool Eat();
+  void AddPaste(char c);
+  void SendPaste();
 
   enum Type {
     UNCOMPLETED,
@@ -31,6 +37,7 @@ class TerminalInputParser {
     MOUSE,
     CURSOR_POSITION,
     CURSOR_SHAPE,
+    MODE_REPORT,
     SPECIAL,
   };
 
@@ -39,12 +46,18 @@ class TerminalInputParser {
     int y;
   };
 
+  struct ModeReport {
+    int mode;
+    int value;
+  };
+
   struct Output {
     Type type;
     union {
       Mouse mouse;
       CursorPosition cursor{};
       int cursor_shape;
+      ModeReport mode_report;
     };
 
     Output(Type t)  // NOLINT
@@ -60,11 +73,20 @@ class TerminalInputParser {
   Output ParseOSC();
   Output ParseMouse(bool altered, bool pressed, std::vector<int> arguments);
   Output ParseCursorPosition(std::vector<int> arguments);
+  Output ParseModeReport(std::vector<int> arguments);
 
   std::function<void(Event)> out_;
   int position_ = -1;
   int timeout_ = 0;
   std::string pending_;
+
+  // Bracketed paste: the text in between the start and end markers is
+  // delivered as a single event, or in pieces of at most 1 MiB. Without an
+  // end marker, it ends after 500 ms without input.
+  bool pasting_ = false;
+  std::string paste_;
+  // Whether the last pasted byte was a CR, so that a CRLF is one new line.
+  bool paste_after_cr_ = false;
 };
 
 }  // namespace ftxui
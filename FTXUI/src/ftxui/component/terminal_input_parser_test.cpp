@@ -5,6 +5,7 @@
 #include <functional>                 // for function
 #include <initializer_list>           // for initializer_list
 #include <memory>                     // for allocator, unique_ptr
+#include <string>                     // for string
 #include <vector>                     // for vector
 
 #include "ftxui/component/event.hpp"  // for Event, Event::Return, Event::ArrowDown, Event::ArrowLeft, Event::ArrowRight, Event::ArrowUp, Event::Backspace, Event::End, Event::Home, Event::Custom, Event::Delete, Event::F1, Event::F10, Event::F11, Event::F12, Event::F2, Event::F3, Event::F4, Event::F5, Event::F6, Event::F7, Event::F8, Event::F9, Event::PageDown, Event::PageUp, Event::Tab, Event::TabReverse, Event::Escape
@@ -468,5 +469,104 @@ TEST(Event, DeviceControlString) {
   EXPECT_EQ(1, received_events[0].cursor_shape());
 }
 
+TEST(Event, ModeReport) {
+  std::vector<Event> received_events;
+  auto parser = TerminalInputParser(
+      [&](Event event) { received_events.push_back(std::move(event)); });
+  for (char c : std::string("\x1B[?2026;2$y\x1B[?2026;0$y")) {
+    parser.Add(c);
+  }
+
+  ASSERT_EQ(2, received_events.size());
+  EXPECT_TRUE(received_events[0].is_mode_report());
+  EXPECT_EQ(2026, received_events[0].mode_report_mode());
+  EXPECT_EQ(2, received_events[0].mode_report_value());
+  EXPECT_TRUE(received_events[1].is_mode_report());
+  EXPECT_EQ(0, received_events[1].mode_report_value());
+}
+
+TEST(Event, BracketedPaste) {
+  std::vector<Event> received_events;
+  auto parser = TerminalInputParser(
+      [&](Event event) { received_events.push_back(std::move(event)); });
+  // Escape sequences and new lines are part of the pasted text.
+  for (char c : std::string("a\x1B[200~de ad\rbe\x1B[Aef\x1B[201~b")) {
+    parser.Add(c);
+  }
+
+  ASSERT_EQ(3, received_events.size());
+  EXPECT_EQ(received_events[0], Event::Character('a'));
+  EXPECT_TRUE(received_events[1].is_paste());
+  EXPECT_EQ(received_events[1].paste(), "de ad\nbe\x1B[Aef");
+  EXPECT_EQ(received_events[1], Event::Paste("de ad\nbe\x1B[Aef"));
+  EXPECT_EQ(received_events[2], Event::Character('b'));
+}
+
+TEST(Event, BracketedPasteCRLF) {
+  std::vector<Event> received_events;
+  auto parser = TerminalInputParser(
+      [&](Event event) { received_events.push_back(std::move(event)); });
+  for (char c : std::string("\x1B[200~a\r\nb\r\rc\n\nd\x1B[201~")) {
+    parser.Add(c);
+  }
+
+  ASSERT_EQ(1, received_events.size());
+  EXPECT_EQ(received_events[0], Event::Paste("a\nb\n\nc\n\nd"));
+}
+
+TEST(Event, BracketedPasteEmpty) {
+  std::vector<Event> received_events;
+  auto parser = TerminalInputParser(
+      [&](Event event) { received_events.push_back(std::move(event)); });
+  for (char c : std::string("\x1B[200~\x1B[201~")) {
+    parser.Add(c);
+  }
+  EXPECT_FALSE(parser.HasPending());
+
+  ASSERT_EQ(1, received_events.size());
+  EXPECT_TRUE(received_events[0].is_paste());
+  EXPECT_EQ(received_events[0].paste(), "");
+  EXPECT_FALSE(received_events[0].is_character());
+}
+
+TEST(Event, BracketedPasteWithoutEnd) {
+  std::vector<Event> received_events;
+  auto parser = TerminalInputParser(
+      [&](Event event) { received_events.push_back(std::move(event)); });
+  for (char c : std::string("\x1B[200~abc")) {
+    parser.Add(c);
+  }
+  EXPECT_TRUE(parser.HasPending());
+  parser.Timeout(499);
+  EXPECT_TRUE(received_events.empty());
+  parser.Timeout(1);
+  EXPECT_FALSE(parser.HasPending());
+  parser.Add('d');
+
+  ASSERT_EQ(2, received_events.size());
+  EXPECT_EQ(received_events[0], Event::Paste("abc"));
+  EXPECT_EQ(received_events[1], Event::Character('d'));
+}
+
+TEST(Event, BracketedPasteLarge) {
+  std::vector<Event> received_events;
+  auto parser = TerminalInputParser(
+      [&](Event event) { received_events.push_back(std::move(event)); });
+  const std::string text(3 << 20, 'a');
+  for (char c : "\x1B[200~" + text + "\x1B[201~") {
+    parser.Add(c);
+  }
+  EXPECT_FALSE(parser.HasPending());
+
+  ASSERT_EQ(4, received_events.size());
+  std::string pasted;
+  for (const Event& event : received_events) {
+    EXPECT_TRUE(event.is_paste());
+    EXPECT_LE(event.paste().size(), 1 << 20);
+    pasted += event.paste();
+  }
+  EXPECT_EQ(pasted, text);
+}
+
 }  // namespace ftxui
    // NOLINTEND
@@ -2,12 +2,37 @@
 // Use of this source code is governed by the MIT license that can be found in
 // the LICENSE file.
 #include <benchmark/benchmark.h>
+#include <atomic>   // for atomic
+#include <cstdint>  // for int64_t
+#include <cstdlib>  // for malloc, free
+#include <new>      // for bad_alloc
+#include <string>   // for string
 
 #include "ftxui/dom/elements.hpp"  // for gauge, separator, operator|, text, Element, hbox, vbox, blink, border, inverted
 #include "ftxui/dom/node.hpp"      // for Render
 #include "ftxui/screen/screen.hpp"  // for Screen
 
 // NOLINTBEGIN
+
+// Count the heap allocations, to report how many are made per frame.
+static std::atomic<int64_t> g_allocations = 0;
+
+void* operator new(std::size_t size) {
+  ++g_allocations;
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
 namespace ftxui {
 
 static void BencharkBasic(benchmark::State& state) {
@@ -48,29 +73,33 @@ static void BencharkText(benchmark::State& state) {
 }
 BENCHMARK(BencharkText)->DenseRange(0, 10, 1);
 
+static Element StyledDocument(int64_t size) {
+  Elements elements;
+  for (int i = 0; i < size; ++i) {
+    elements.push_back(vbox({
+        text("Test") | bold,
+        text("Test") | dim,
+        text("Test") | inverted,
+        text("Test") | underlined,
+        text("Test") | underlinedDouble,
+        text("Test") | strikethrough,
+        text("Test") | color(Color::Red),
+        text("Test") | bgcolor(Color::Red),
+        text("Test") | color(Color::RGB(42, 87, 124)),
+        text("Test") | bgcolor(Color::RGB(42, 87, 124)),
+        text("Test") | color(Color::RGB(42, 87, 124)) |
+            bgcolor(Color::RGB(172, 94, 212)),
+        text("Test") | blink,
+        text("Test") | automerge,
+    }));
+    elements.push_back(separator());
+  }
+  return hbox(std::move(elements));
+}
+
 static void BenchmarkStyle(benchmark::State& state) {
   while (state.KeepRunning()) {
-    Elements elements;
-    for (int i = 0; i < state.range(0); ++i) {
-      elements.push_back(vbox({
-          text("Test") | bold,
-          text("Test") | dim,
-          text("Test") | inverted,
-          text("Test") | underlined,
-          text("Test") | underlinedDouble,
-          text("Test") | strikethrough,
-          text("Test") | color(Color::Red),
-          text("Test") | bgcolor(Color::Red),
-          text("Test") | color(Color::RGB(42, 87, 124)),
-          text("Test") | bgcolor(Color::RGB(42, 87, 124)),
-          text("Test") | color(Color::RGB(42, 87, 124)) |
-              bgcolor(Color::RGB(172, 94, 212)),
-          text("Test") | blink,
-          text("Test") | automerge,
-      }));
-      elements.push_back(separator());
-    }
-    auto document = hbox(std::move(elements));
+    auto document = StyledDocument(state.range(0));
     Screen screen(state.range(1), state.range(1));
     Render(screen, document);
     screen.ToString();
@@ -82,5 +111,45 @@ BENCHMARK(BenchmarkStyle)
         benchmark::CreateDenseRange(10, 200, 20),  // Screen width.
     });
 
+// Print an already rendered screen, as done for every frame. ToString()
+// returns a new string, while ToString(output) appends to a buffer reused from
+// frame to frame.
+static void BenchmarkStyleToString(benchmark::State& state) {
+  auto document = StyledDocument(state.range(0));
+  Screen screen(state.range(1), state.range(1));
+  Render(screen, document);
+  const int64_t allocations = g_allocations;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(screen.ToString());
+  }
+  state.counters["allocations_per_frame"] = benchmark::Counter(
+      double(g_allocations - allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BenchmarkStyleToString)
+    ->ArgsProduct({
+        benchmark::CreateDenseRange(1, 10, 3),     // Number of elements.
+        benchmark::CreateDenseRange(10, 200, 20),  // Screen width.
+    });
+
+static void BenchmarkStyleToStringReusedBuffer(benchmark::State& state) {
+  auto document = StyledDocument(state.range(0));
+  Screen screen(state.range(1), state.range(1));
+  Render(screen, document);
+  std::string output;
+  const int64_t allocations = g_allocations;
+  while (state.KeepRunning()) {
+    output.clear();
+    screen.ToString(output);
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.counters["allocations_per_frame"] = benchmark::Counter(
+      double(g_allocations - allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BenchmarkStyleToStringReusedBuffer)
+    ->ArgsProduct({
+        benchmark::CreateDenseRange(1, 10, 3),     // Number of elements.
+        benchmark::CreateDenseRange(10, 200, 20),  // Screen width.
+    });
+
 }  // namespace ftxui
 // NOLINTEND
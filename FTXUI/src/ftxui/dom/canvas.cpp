@@ -10,6 +10,7 @@
 #include <ftxui/screen/color.hpp>  // for Color
 #include <functional>              // for function
 #include <map>                     // for map
+#include <string>                  // for string
 #include <memory>                  // for make_shared
 #include <utility>                 // for move, pair
 #include <vector>                  // for vector
@@ -144,8 +145,10 @@ void Canvas::DrawPointOn(int x, int y) {
     cell.type = CellType::kBraille;
   }
 
-  cell.content.character[1] |= g_map_braille[x % 2][y % 4][0];  // NOLINT
-  cell.content.character[2] |= g_map_braille[x % 2][y % 4][1];  // NOLINT
+  std::string character = cell.content.character;
+  character[1] |= g_map_braille[x % 2][y % 4][0];  // NOLINT
+  character[2] |= g_map_braille[x % 2][y % 4][1];  // NOLINT
+  cell.content.character = character;
 }
 
 /// @brief Erase a braille dot.
@@ -161,8 +164,10 @@ void Canvas::DrawPointOff(int x, int y) {
     cell.type = CellType::kBraille;
   }
 
-  cell.content.character[1] &= ~(g_map_braille[x % 2][y % 4][0]);  // NOLINT
-  cell.content.character[2] &= ~(g_map_braille[x % 2][y % 4][1]);  // NOLINT
+  std::string character = cell.content.character;
+  character[1] &= ~(g_map_braille[x % 2][y % 4][0]);  // NOLINT
+  character[2] &= ~(g_map_braille[x % 2][y % 4][1]);  // NOLINT
+  cell.content.character = character;
 }
 
 /// @brief Toggle a braille dot. A filled one will be erased, and the other will
@@ -179,8 +184,10 @@ void Canvas::DrawPointToggle(int x, int y) {
     cell.type = CellType::kBraille;
   }
 
-  cell.content.character[1] ^= g_map_braille[x % 2][y % 4][0];  // NOLINT
-  cell.content.character[2] ^= g_map_braille[x % 2][y % 4][1];  // NOLINT
+  std::string character = cell.content.character;
+  character[1] ^= g_map_braille[x % 2][y % 4][0];  // NOLINT
+  character[2] ^= g_map_braille[x % 2][y % 4][1];  // NOLINT
+  cell.content.character = character;
 }
 
 /// @brief Draw a line made of braille dots.
@@ -32,6 +32,19 @@ const std::array<const char*, 33> palette16code = {
     "97", "107",  //
 };
 
+// Decimal representation of every uint8_t, to print colors without
+// std::to_string.
+const std::string& DecimalCode(uint8_t value) {
+  static const std::array<std::string, 256> codes = [] {
+    std::array<std::string, 256> table;
+    for (size_t i = 0; i < table.size(); ++i) {
+      table[i] = std::to_string(i);
+    }
+    return table;
+  }();
+  return codes[value];  // NOLINT
+}
+
 }  // namespace
 
 bool Color::operator==(const Color& rhs) const {
@@ -44,33 +57,32 @@ bool Color::operator!=(const Color& rhs) const {
 }
 
 std::string Color::Print(bool is_background_color) const {
-  if (is_background_color) {
-    switch (type_) {
-      case ColorType::Palette1:
-        return "49";
-      case ColorType::Palette16:
-        return palette16code[2 * red_ + 1];  // NOLINT
-      case ColorType::Palette256:
-        return "48;5;" + std::to_string(red_);
-      case ColorType::TrueColor:
-        return "48;2;" + std::to_string(red_) + ";" + std::to_string(green_) +
-               ";" + std::to_string(blue_);
-    }
-  } else {
-    switch (type_) {
-      case ColorType::Palette1:
-        return "39";
-      case ColorType::Palette16:
-        return palette16code[2 * red_];  // NOLINT
-      case ColorType::Palette256:
-        return "38;5;" + std::to_string(red_);
-      case ColorType::TrueColor:
-        return "38;2;" + std::to_string(red_) + ";" + std::to_string(green_) +
-               ";" + std::to_string(blue_);
-    }
+  std::string output;
+  PrintTo(output, is_background_color);
+  return output;
+}
+
+void Color::PrintTo(std::string& output, bool is_background_color) const {
+  switch (type_) {
+    case ColorType::Palette1:
+      output += is_background_color ? "49" : "39";
+      return;
+    case ColorType::Palette16:
+      output += palette16code[2 * red_ + is_background_color];  // NOLINT
+      return;
+    case ColorType::Palette256:
+      output += is_background_color ? "48;5;" : "38;5;";
+      output += DecimalCode(red_);
+      return;
+    case ColorType::TrueColor:
+      output += is_background_color ? "48;2;" : "38;2;";
+      output += DecimalCode(red_);
+      output += ';';
+      output += DecimalCode(green_);
+      output += ';';
+      output += DecimalCode(blue_);
+      return;
   }
-  // NOTREACHED();
-  return "";
 }
 
 /// @brief Build a transparent color.
@@ -1,8 +1,8 @@
 // Copyright 2020 Arthur Sonzogni. All rights reserved.
 // Use of this source code is governed by the MIT license that can be found in
 // the LICENSE file.
-#include <sstream>  // IWYU pragma: keep
-#include <string>
+#include <algorithm>  // for fill, max
+#include <cstddef>    // for size_t
 #include <vector>
 
 #include "ftxui/screen/image.hpp"
@@ -21,19 +21,20 @@ Image::Image(int dimx, int dimy)
     : stencil{0, dimx - 1, 0, dimy - 1},
       dimx_(dimx),
       dimy_(dimy),
-      pixels_(dimy, std::vector<Pixel>(dimx)) {}
+      pixels_(static_cast<size_t>(std::max(dimx, 0)) *
+              static_cast<size_t>(std::max(dimy, 0))) {}
 
 /// @brief Access a character in a cell at a given position.
 /// @param x The cell position along the x-axis.
 /// @param y The cell position along the y-axis.
-std::string& Image::at(int x, int y) {
+Glyph& Image::at(int x, int y) {
   return PixelAt(x, y).character;
 }
 
 /// @brief Access a character in a cell at a given position.
 /// @param x The cell position along the x-axis.
 /// @param y The cell position along the y-axis.
-const std::string& Image::at(int x, int y) const {
+const Glyph& Image::at(int x, int y) const {
   return PixelAt(x, y).character;
 }
 
@@ -41,23 +42,19 @@ const std::string& Image::at(int x, int y) const {
 /// @param x The cell position along the x-axis.
 /// @param y The cell position along the y-axis.
 Pixel& Image::PixelAt(int x, int y) {
-  return stencil.Contain(x, y) ? pixels_[y][x] : dev_null_pixel();
+  return stencil.Contain(x, y) ? pixels_[y * dimx_ + x] : dev_null_pixel();
 }
 
 /// @brief Access a cell (Pixel) at a given position.
 /// @param x The cell position along the x-axis.
 /// @param y The cell position along the y-axis.
 const Pixel& Image::PixelAt(int x, int y) const {
-  return stencil.Contain(x, y) ? pixels_[y][x] : dev_null_pixel();
+  return stencil.Contain(x, y) ? pixels_[y * dimx_ + x] : dev_null_pixel();
 }
 
 /// @brief Clear all the pixel from the screen.
 void Image::Clear() {
-  for (auto& line : pixels_) {
-    for (auto& cell : line) {
-      cell = Pixel();
-    }
-  }
+  std::fill(pixels_.begin(), pixels_.end(), Pixel());
 }
 
 }  // namespace ftxui
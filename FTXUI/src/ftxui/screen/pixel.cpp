@@ -0,0 +1,131 @@
+// Copyright 2025 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#include <algorithm>      // for min
+#include <array>          // for array
+#include <atomic>         // for atomic
+#include <cstdint>        // for uint32_t
+#include <cstring>        // for memcpy, memcmp
+#include <memory>         // for unique_ptr
+#include <mutex>          // for mutex, lock_guard
+#include <optional>       // for optional, nullopt
+#include <string>         // for string
+#include <string_view>    // for string_view
+#include <unordered_map>  // for unordered_map
+
+#include "ftxui/screen/pixel.hpp"
+#include "ftxui/screen/string.hpp"  // for string_width
+
+namespace ftxui {
+
+namespace {
+
+// Grapheme clusters too long to be stored inline. They are never removed, so
+// views into them stay valid: they are stored in fixed-size chunks that are
+// never moved. Interning takes the mutex, reading an interned glyph doesn't.
+//
+// The table is bounded: past kMaxInterned distinct clusters, new ones are
+// drawn as U+FFFD. Real text only has a few long clusters (emoji sequences,
+// stacked combining marks), so this only stops runaway growth.
+constexpr uint32_t kChunkSize = 256;
+constexpr uint32_t kMaxChunks = 256;
+constexpr uint32_t kMaxInterned = kChunkSize * kMaxChunks;
+
+struct InternTable {
+  std::mutex mutex;
+  std::unordered_map<std::string_view, uint32_t> index;
+  std::array<std::unique_ptr<std::string[]>, kMaxChunks> owned;
+  // Published chunks, and the number of glyphs stored in them.
+  std::array<std::atomic<const std::string*>, kMaxChunks> chunks = {};
+  std::atomic<uint32_t> size = 0;
+};
+
+InternTable& intern_table() {
+  static InternTable table;  // NOLINT
+  return table;
+}
+
+uint8_t Width(std::string_view str) {
+  // Quick path: a single printable ASCII character.
+  if (str.size() == 1 && str[0] >= ' ' && str[0] < 0x7F) {  // NOLINT
+    return 1;
+  }
+  return static_cast<uint8_t>(std::min(string_width(std::string(str)), 3));
+}
+
+std::optional<uint32_t> Intern(std::string_view str) {
+  InternTable& table = intern_table();
+  const std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.index.find(str);
+  if (it != table.index.end()) {
+    return it->second;
+  }
+  const uint32_t id = table.size.load(std::memory_order_relaxed);
+  if (id == kMaxInterned) {
+    return std::nullopt;
+  }
+  const uint32_t chunk = id / kChunkSize;
+  if (!table.owned[chunk]) {
+    table.owned[chunk] = std::make_unique<std::string[]>(kChunkSize);
+    table.chunks[chunk].store(table.owned[chunk].get(),
+                              std::memory_order_release);
+  }
+  std::string& glyph = table.owned[chunk][id % kChunkSize];
+  glyph = str;
+  table.index.emplace(glyph, id);
+  table.size.store(id + 1, std::memory_order_release);
+  return id;
+}
+
+// The id comes from a Glyph built after Intern() returned it, so the chunk
+// and the string in it are already published.
+std::string_view Interned(uint32_t id) {
+  const InternTable& table = intern_table();
+  if (id >= table.size.load(std::memory_order_acquire)) {
+    return {};
+  }
+  return table.chunks[id / kChunkSize].load(
+      std::memory_order_acquire)[id % kChunkSize];
+}
+
+}  // namespace
+
+/// @brief Build a glyph from its UTF-8 representation.
+Glyph::Glyph(std::string_view str) : size_(0), width_(Width(str)) {
+  if (str.size() <= kInlineCapacity) {
+    std::memcpy(data_, str.data(), str.size());
+    size_ = static_cast<uint8_t>(str.size());
+    return;
+  }
+  if (const std::optional<uint32_t> id = Intern(str)) {
+    std::memcpy(data_, &*id, sizeof(*id));
+    size_ = kInterned;
+    return;
+  }
+  // The intern table is full: U+FFFD, padded to the same width.
+  const std::string_view replacement = "\xEF\xBF\xBD";
+  std::memcpy(data_, replacement.data(), replacement.size());
+  size_ = static_cast<uint8_t>(replacement.size());
+  for (int i = 1; i < width_; ++i) {
+    data_[size_++] = ' ';
+  }
+}
+
+/// @brief The UTF-8 representation of the glyph.
+std::string_view Glyph::view() const {
+  if (size_ != kInterned) {
+    return {data_, size_};
+  }
+  uint32_t id = 0;
+  std::memcpy(&id, data_, sizeof(id));
+  return Interned(id);
+}
+
+/// @brief Compare two glyphs. Interned glyphs are unique, so comparing the
+/// bytes is enough.
+bool Glyph::operator==(const Glyph& other) const {
+  return size_ == other.size_ && width_ == other.width_ &&
+         std::memcmp(data_, other.data_, sizeof(data_)) == 0;
+}
+
+}  // namespace ftxui
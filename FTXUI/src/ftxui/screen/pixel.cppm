@@ -12,5 +12,6 @@ export module ftxui.screen.pixel;
  * @brief The FTXUI ftxui:: namespace
  */
 export namespace ftxui {
+    using ftxui::Glyph;
     using ftxui::Pixel;
 }
@@ -1,18 +1,22 @@
 // Copyright 2020 Arthur Sonzogni. All rights reserved.
 // Use of this source code is governed by the MIT license that can be found in
 // the LICENSE file.
-#include <cstddef>  // for size_t
+#include <algorithm>  // for copy, copy_backward, fill, max, min
+#include <cstddef>    // for size_t, ptrdiff_t
 #include <cstdint>
-#include <iostream>  // for operator<<, stringstream, basic_ostream, flush, cout, ostream
+#include <cstdlib>     // for abs
+#include <functional>  // for less
+#include <iostream>  // for operator<<, basic_ostream, flush, cout, ostream
 #include <limits>
-#include <map>      // for _Rb_tree_const_iterator, map, operator!=, operator==
-#include <sstream>  // IWYU pragma: keep
-#include <utility>  // for pair
+#include <map>       // for _Rb_tree_const_iterator, map, operator!=, operator==
+#include <optional>  // for optional
+#include <string>    // for string, to_string
+#include <utility>   // for pair
+#include <vector>    // for vector
 
 #include "ftxui/screen/image.hpp"  // for Image
 #include "ftxui/screen/pixel.hpp"  // for Pixel
 #include "ftxui/screen/screen.hpp"
-#include "ftxui/screen/string.hpp"    // for string_width
 #include "ftxui/screen/terminal.hpp"  // for Dimensions, Size
 
 #if defined(_WIN32)
@@ -67,61 +71,188 @@ void WindowsEmulateVT100Terminal() {
 }
 #endif
 
+// Append a parameter to the list of SGR parameters written since `start`.
+void AddParameter(std::string& output, size_t start, const char* parameter) {
+  if (output.size() != start) {
+    output += ';';
+  }
+  output += parameter;
+}
+
+void AddColor(std::string& output,
+              size_t start,
+              const Color& color,
+              bool background) {
+  if (output.size() != start) {
+    output += ';';
+  }
+  color.PrintTo(output, background);
+}
+
+// Same as UpdatePixelStyle(), printing a single SGR sequence. It either
+// updates the attributes which changed, or resets all of them and sets the
+// ones of `next`, whichever is shorter. Both are written to `output`, and the
+// longer one is erased.
+void UpdatePixelStyleCompact(std::string& output,
+                             const Pixel& prev,
+                             const Pixel& next) {
+  const size_t sequence = output.size();
+  output += "\x1B[";
+  const size_t update = output.size();
+  if ((prev.bold && !next.bold) || (prev.dim && !next.dim)) {
+    AddParameter(output, update, "22");  // BOLD_AND_DIM_RESET
+    if (next.bold) {
+      AddParameter(output, update, "1");
+    }
+    if (next.dim) {
+      AddParameter(output, update, "2");
+    }
+  } else {
+    if (next.bold && !prev.bold) {
+      AddParameter(output, update, "1");
+    }
+    if (next.dim && !prev.dim) {
+      AddParameter(output, update, "2");
+    }
+  }
+  if (next.underlined != prev.underlined ||
+      next.underlined_double != prev.underlined_double) {
+    AddParameter(output, update,
+                 next.underlined          ? "4"
+                 : next.underlined_double ? "21"
+                                          : "24");
+  }
+  if (next.blink != prev.blink) {
+    AddParameter(output, update, next.blink ? "5" : "25");
+  }
+  if (next.inverted != prev.inverted) {
+    AddParameter(output, update, next.inverted ? "7" : "27");
+  }
+  if (next.italic != prev.italic) {
+    AddParameter(output, update, next.italic ? "3" : "23");
+  }
+  if (next.strikethrough != prev.strikethrough) {
+    AddParameter(output, update, next.strikethrough ? "9" : "29");
+  }
+  if (next.foreground_color != prev.foreground_color) {
+    AddColor(output, update, next.foreground_color, false);
+  }
+  if (next.background_color != prev.background_color) {
+    AddColor(output, update, next.background_color, true);
+  }
+  const size_t reset = output.size();
+  if (reset == update) {
+    output.resize(sequence);
+    return;
+  }
+
+  output += '0';
+  if (next.bold) {
+    AddParameter(output, reset, "1");
+  }
+  if (next.dim) {
+    AddParameter(output, reset, "2");
+  }
+  if (next.underlined || next.underlined_double) {
+    AddParameter(output, reset, next.underlined ? "4" : "21");
+  }
+  if (next.blink) {
+    AddParameter(output, reset, "5");
+  }
+  if (next.inverted) {
+    AddParameter(output, reset, "7");
+  }
+  if (next.italic) {
+    AddParameter(output, reset, "3");
+  }
+  if (next.strikethrough) {
+    AddParameter(output, reset, "9");
+  }
+  if (next.foreground_color != Color::Default) {
+    AddColor(output, reset, next.foreground_color, false);
+  }
+  if (next.background_color != Color::Default) {
+    AddColor(output, reset, next.background_color, true);
+  }
+
+  if (output.size() - reset < reset - update) {
+    output.erase(update, reset - update);
+  } else {
+    output.resize(reset);
+  }
+  output += 'm';
+}
+
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
 void UpdatePixelStyle(const Screen* screen,
-                      std::stringstream& ss,
+                      std::string& output,
                       const Pixel& prev,
                       const Pixel& next) {
   // See https://gist.github.com/egmontkob/eb114294efbcd5adb1944c9f3cb5feda
   if (FTXUI_UNLIKELY(next.hyperlink != prev.hyperlink)) {
-    ss << "\x1B]8;;" << screen->Hyperlink(next.hyperlink) << "\x1B\\";
+    output += "\x1B]8;;";
+    output += screen->Hyperlink(next.hyperlink);
+    output += "\x1B\\";
+  }
+
+  if (screen->compact_style()) {
+    UpdatePixelStyleCompact(output, prev, next);
+    return;
   }
 
   // Bold
   if (FTXUI_UNLIKELY((next.bold ^ prev.bold) | (next.dim ^ prev.dim))) {
     // BOLD_AND_DIM_RESET:
-    ss << ((prev.bold && !next.bold) || (prev.dim && !next.dim) ? "\x1B[22m"
-                                                                : "");
-    ss << (next.bold ? "\x1B[1m" : "");  // BOLD_SET
-    ss << (next.dim ? "\x1B[2m" : "");   // DIM_SET
+    if ((prev.bold && !next.bold) || (prev.dim && !next.dim)) {
+      output += "\x1B[22m";
+    }
+    if (next.bold) {
+      output += "\x1B[1m";  // BOLD_SET
+    }
+    if (next.dim) {
+      output += "\x1B[2m";  // DIM_SET
+    }
   }
 
   // Underline
   if (FTXUI_UNLIKELY(next.underlined != prev.underlined ||
                      next.underlined_double != prev.underlined_double)) {
-    ss << (next.underlined          ? "\x1B[4m"     // UNDERLINE
-           : next.underlined_double ? "\x1B[21m"    // UNDERLINE_DOUBLE
-                                    : "\x1B[24m");  // UNDERLINE_RESET
+    output += (next.underlined          ? "\x1B[4m"     // UNDERLINE
+               : next.underlined_double ? "\x1B[21m"    // UNDERLINE_DOUBLE
+                                        : "\x1B[24m");  // UNDERLINE_RESET
   }
 
   // Blink
   if (FTXUI_UNLIKELY(next.blink != prev.blink)) {
-    ss << (next.blink ? "\x1B[5m"     // BLINK_SET
-                      : "\x1B[25m");  // BLINK_RESET
+    output += (next.blink ? "\x1B[5m"     // BLINK_SET
+                          : "\x1B[25m");  // BLINK_RESET
   }
 
   // Inverted
   if (FTXUI_UNLIKELY(next.inverted != prev.inverted)) {
-    ss << (next.inverted ? "\x1B[7m"     // INVERTED_SET
-                         : "\x1B[27m");  // INVERTED_RESET
+    output += (next.inverted ? "\x1B[7m"     // INVERTED_SET
+                             : "\x1B[27m");  // INVERTED_RESET
   }
 
   // Italics
   if (FTXUI_UNLIKELY(next.italic != prev.italic)) {
-    ss << (next.italic ? "\x1B[3m"     // ITALIC_SET
-                       : "\x1B[23m");  // ITALIC_RESET
+    output += (next.italic ? "\x1B[3m"     // ITALIC_SET
+                           : "\x1B[23m");  // ITALIC_RESET
   }
 
   // StrikeThrough
   if (FTXUI_UNLIKELY(next.strikethrough != prev.strikethrough)) {
-    ss << (next.strikethrough ? "\x1B[9m"     // CROSSED_OUT
-                              : "\x1B[29m");  // CROSSED_OUT_RESET
+    output += (next.strikethrough ? "\x1B[9m"     // CROSSED_OUT
+                                  : "\x1B[29m");  // CROSSED_OUT_RESET
   }
 
   if (FTXUI_UNLIKELY(next.foreground_color != prev.foreground_color ||
                      next.background_color != prev.background_color)) {
-    ss << "\x1B[" + next.foreground_color.Print(false) + "m";
-    ss << "\x1B[" + next.background_color.Print(true) + "m";
+    output += "\x1B[";
+    next.foreground_color.PrintTo(output, false);
+    output += "m\x1B[";
+    next.background_color.PrintTo(output, true);
+    output += 'm';
   }
 }
 
@@ -150,7 +281,7 @@ struct TileEncoding {
 };
 
 // clang-format off
-const std::map<std::string, TileEncoding> tile_encoding = { // NOLINT
+const std::map<std::string, TileEncoding, std::less<>> tile_encoding = { // NOLINT
     {"─", {1, 0, 1, 0, 0}},
     {"━", {2, 0, 2, 0, 0}},
     {"╍", {2, 0, 2, 0, 0}},
@@ -293,8 +424,8 @@ const std::map<std::string, TileEncoding> tile_encoding = { // NOLINT
 };
 // clang-format on
 
-template <class A, class B>
-std::map<B, A> InvertMap(const std::map<A, B> input) {
+template <class A, class B, class Compare>
+std::map<B, A> InvertMap(const std::map<A, B, Compare>& input) {
   std::map<B, A> output;
   for (const auto& it : input) {
     output[it.second] = it.first;
@@ -305,12 +436,12 @@ std::map<B, A> InvertMap(const std::map<A, B> input) {
 const std::map<TileEncoding, std::string> tile_encoding_inverse =  // NOLINT
     InvertMap(tile_encoding);
 
-void UpgradeLeftRight(std::string& left, std::string& right) {
-  const auto it_left = tile_encoding.find(left);
+void UpgradeLeftRight(Glyph& left, Glyph& right) {
+  const auto it_left = tile_encoding.find(left.view());
   if (it_left == tile_encoding.end()) {
     return;
   }
-  const auto it_right = tile_encoding.find(right);
+  const auto it_right = tile_encoding.find(right.view());
   if (it_right == tile_encoding.end()) {
     return;
   }
@@ -334,12 +465,12 @@ void UpgradeLeftRight(std::string& left, std::string& right) {
   }
 }
 
-void UpgradeTopDown(std::string& top, std::string& down) {
-  const auto it_top = tile_encoding.find(top);
+void UpgradeTopDown(Glyph& top, Glyph& down) {
+  const auto it_top = tile_encoding.find(top.view());
   if (it_top == tile_encoding.end()) {
     return;
   }
-  const auto it_down = tile_encoding.find(down);
+  const auto it_down = tile_encoding.find(down.view());
   if (it_down == tile_encoding.end()) {
     return;
   }
@@ -367,6 +498,143 @@ bool ShouldAttemptAutoMerge(Pixel& pixel) {
   return pixel.automerge && pixel.character.size() == 3;
 }
 
+// Whether two pixels are printed identically. `automerge` isn't compared, it
+// only matters before ApplyShader().
+bool SamePixel(const Screen& screen,
+               const Pixel& a,
+               const Screen& other_screen,
+               const Pixel& b) {
+  if (a.blink != b.blink || a.bold != b.bold || a.dim != b.dim ||
+      a.italic != b.italic || a.inverted != b.inverted ||
+      a.underlined != b.underlined ||
+      a.underlined_double != b.underlined_double ||
+      a.strikethrough != b.strikethrough) {
+    return false;
+  }
+  if (a.foreground_color != b.foreground_color ||
+      a.background_color != b.background_color ||
+      a.character != b.character) {
+    return false;
+  }
+  // Hyperlink ids are only meaningful within a single frame.
+  return (a.hyperlink == 0 && b.hyperlink == 0) ||
+         screen.Hyperlink(a.hyperlink) == other_screen.Hyperlink(b.hyperlink);
+}
+
+// Move the cursor from (cursor_x, cursor_y) to (x, y) using relative
+// movements. A negative cursor_x means the column is unknown, because the
+// cursor was left on the right margin.
+void MoveCursor(std::string& output,
+                int& cursor_x,
+                int& cursor_y,
+                int x,
+                int y) {
+  if (y != cursor_y) {
+    output += "\x1B[" + std::to_string(y - cursor_y) + "B";  // MOVE_DOWN
+    cursor_y = y;
+  }
+  if (x == cursor_x) {
+    return;
+  }
+  if (cursor_x < 0 || x < cursor_x) {
+    output += '\r';  // MOVE_LEFT
+    cursor_x = 0;
+  }
+  if (x > cursor_x) {
+    output += "\x1B[" + std::to_string(x - cursor_x) + "C";  // MOVE_RIGHT
+  }
+  cursor_x = x;
+}
+
+// Moving the cursor costs at least 4 bytes. Reprinting short runs of unchanged
+// cells in between two damaged ones is cheaper.
+constexpr int kMaxReprintedGap = 4;
+
+// A vertical scroll of the lines [top, bottom]. A positive shift moves the
+// content up, a negative one moves it down. A zero shift means no scroll.
+struct Scroll {
+  int top = 0;
+  int bottom = 0;
+  int shift = 0;
+};
+
+// The largest number of lines a scroll is looked for.
+constexpr int kMaxScroll = 3;
+
+// Find the vertical scroll transforming `previous` into `screen` with the
+// fewest damaged lines left, if it is worth it.
+Scroll FindScroll(const Screen& screen,
+                  const Pixel* pixels,
+                  const Screen& previous,
+                  const Pixel* previous_pixels) {
+  const int dimx = screen.dimx();
+  const int dimy = screen.dimy();
+  auto same_line = [&](int y, int previous_y) {
+    const Pixel* line = pixels + y * dimx;
+    const Pixel* previous_line = previous_pixels + previous_y * dimx;
+    for (int x = 0; x < dimx; ++x) {
+      if (!SamePixel(screen, line[x], previous, previous_line[x])) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::vector<bool> damaged_line(dimy);
+  int damaged = 0;
+  for (int y = 0; y < dimy; ++y) {
+    damaged_line[y] = !same_line(y, y);
+    damaged += damaged_line[y];
+  }
+
+  Scroll best;
+  // A scroll must save at least one line, on top of the one its escape
+  // sequences cost.
+  int best_damaged = damaged - 1;
+  for (int shift = -kMaxScroll; shift <= kMaxScroll && best_damaged > 0;
+       ++shift) {
+    if (shift == 0) {
+      continue;
+    }
+
+    // The lines the scroll brings to their right place.
+    int first = -1;
+    int last = -1;
+    int moved = 0;
+    for (int y = std::max(0, -shift); y < std::min(dimy, dimy - shift); ++y) {
+      if (damaged_line[y] && same_line(y, y + shift)) {
+        first = (first < 0) ? y : first;
+        last = y;
+        ++moved;
+      }
+    }
+    if (moved == 0) {
+      continue;
+    }
+
+    Scroll scroll;
+    scroll.shift = shift;
+    scroll.top = (shift > 0) ? first : first + shift;
+    scroll.bottom = (shift > 0) ? last + shift : last;
+
+    // The moved lines are fixed. In the region, the lines which were right
+    // stay right only when scrolled from an identical line.
+    int scroll_damaged = damaged - moved;
+    for (int y = scroll.top; y <= scroll.bottom; ++y) {
+      const int from = y + shift;
+      if (!damaged_line[y] &&
+          (from < scroll.top || from > scroll.bottom || !same_line(y, from))) {
+        ++scroll_damaged;
+      }
+    }
+    if (scroll_damaged < best_damaged) {
+      best = scroll;
+      best_damaged = scroll_damaged;
+    }
+  }
+  return best;
+}
+
 }  // namespace
 
 /// A fixed dimension.
@@ -413,39 +681,208 @@ Screen::Screen(int dimx, int dimy) : Image{dimx, dimy} {
 /// @note Don't forget to flush stdout. Alternatively, you can use
 /// Screen::Print();
 std::string Screen::ToString() const {
-  std::stringstream ss;
+  std::string output;
+  ToString(output);
+  return output;
+}
 
+/// Same as ToString(), but appending to `output`. Reusing the same buffer from
+/// frame to frame avoids allocating.
+/// @param output The buffer to append to.
+void Screen::ToString(std::string& output) const {
   const Pixel default_pixel;
   const Pixel* previous_pixel_ref = &default_pixel;
 
   for (int y = 0; y < dimy_; ++y) {
     // New line in between two lines.
     if (y != 0) {
-      UpdatePixelStyle(this, ss, *previous_pixel_ref, default_pixel);
+      UpdatePixelStyle(this, output, *previous_pixel_ref, default_pixel);
       previous_pixel_ref = &default_pixel;
-      ss << "\r\n";
+      output += "\r\n";
     }
 
     // After printing a fullwith character, we need to skip the next cell.
     bool previous_fullwidth = false;
-    for (const auto& pixel : pixels_[y]) {
+    for (int x = 0; x < dimx_; ++x) {
+      const Pixel& pixel = pixels_[y * dimx_ + x];
       if (!previous_fullwidth) {
-        UpdatePixelStyle(this, ss, *previous_pixel_ref, pixel);
+        UpdatePixelStyle(this, output, *previous_pixel_ref, pixel);
         previous_pixel_ref = &pixel;
         if (pixel.character.empty()) {
-          ss << " ";
+          output += ' ';
         } else {
-          ss << pixel.character;
+          output += pixel.character.view();
+        }
+      }
+      previous_fullwidth = (pixel.character.width() == 2);
+    }
+  }
+
+  // Reset the style to default:
+  UpdatePixelStyle(this, output, *previous_pixel_ref, default_pixel);
+}
+
+/// Produce a std::string that updates a terminal currently displaying
+/// `previous` into this screen. Only the damaged cells are printed, using
+/// cursor movements relative to the top-left corner of the screen.
+///
+/// Like ToString(), the output assumes the cursor starts at the top-left
+/// corner and leaves it after the last cell of the last line.
+///
+/// When the dimensions differ, or when more than half of the cells changed,
+/// this falls back to a full ToString().
+/// @param previous The screen currently displayed by the terminal.
+std::string Screen::ToDiffString(const Screen& previous) const {
+  std::string output;
+  ToDiffString(previous, output);
+  return output;
+}
+
+/// Same as ToDiffString(), but appending to `output`. Reusing the same buffer
+/// from frame to frame avoids allocating.
+///
+/// With `scroll_region`, lines which only moved vertically are scrolled by the
+/// terminal, inside a scroll region (DECSTBM), instead of being reprinted.
+/// Scroll regions are positioned relatively to the top of the terminal, so
+/// this must only be used for a screen drawn there.
+/// @param previous The screen currently displayed by the terminal.
+/// @param output The buffer to append to.
+/// @param scroll_region Whether to use scroll regions.
+void Screen::ToDiffString(const Screen& previous,
+                          std::string& output,
+                          bool scroll_region) const {
+  if (previous.dimx_ != dimx_ || previous.dimy_ != dimy_ || dimx_ == 0 ||
+      dimy_ == 0) {
+    ToString(output);
+    return;
+  }
+
+  // Diff against what the terminal displays after scrolling.
+  const Screen* base = &previous;
+  std::optional<Screen> scrolled;
+  Scroll scroll;
+  if (scroll_region) {
+    scroll = FindScroll(*this, pixels_.data(), previous,
+                        previous.pixels_.data());
+  }
+  if (scroll.shift != 0) {
+    scrolled = previous;
+    auto line = [&](int y) {
+      return scrolled->pixels_.begin() + static_cast<ptrdiff_t>(y) * dimx_;
+    };
+    if (scroll.shift > 0) {
+      std::copy(line(scroll.top + scroll.shift), line(scroll.bottom + 1),
+                line(scroll.top));
+      std::fill(line(scroll.bottom + 1 - scroll.shift),
+                line(scroll.bottom + 1), Pixel());
+    } else {
+      std::copy_backward(line(scroll.top), line(scroll.bottom + 1 + scroll.shift),
+                         line(scroll.bottom + 1));
+      std::fill(line(scroll.top), line(scroll.top - scroll.shift), Pixel());
+    }
+    base = &*scrolled;
+  }
+
+  int damaged = 0;
+  for (int y = 0; y < dimy_; ++y) {
+    for (int x = 0; x < dimx_; ++x) {
+      const int i = y * dimx_ + x;
+      damaged += !SamePixel(*this, pixels_[i], *base, base->pixels_[i]);
+    }
+  }
+  if (2 * damaged > dimx_ * dimy_) {
+    ToString(output);
+    return;
+  }
+
+  if (scroll.shift != 0) {
+    // Setting and resetting the region moves the cursor to the top-left
+    // corner, where it already is.
+    output += "\x1B[" + std::to_string(scroll.top + 1) + ";" +
+              std::to_string(scroll.bottom + 1) + "r";  // DECSTBM
+    output += "\x1B[" + std::to_string(std::abs(scroll.shift)) +
+              (scroll.shift > 0 ? "S" : "T");  // SCROLL_UP / SCROLL_DOWN
+    output += "\x1B[r";
+  }
+
+  const Pixel default_pixel;
+  const Pixel* previous_pixel_ref = &default_pixel;
+  int cursor_x = 0;
+  int cursor_y = 0;
+
+  for (int y = 0; y < dimy_; ++y) {
+    const Pixel* line = &pixels_[y * dimx_];
+    const Pixel* previous_line = &base->pixels_[y * dimx_];
+
+    int x = 0;
+    while (x < dimx_ &&
+           SamePixel(*this, line[x], *base, previous_line[x])) {
+      ++x;
+    }
+    if (x == dimx_) {
+      continue;
+    }
+
+    // Fullwidth glyphs span two cells. Overwriting half of one of them erases
+    // it, so lines containing one are fully reprinted.
+    bool has_fullwidth = false;
+    for (int i = 0; i < dimx_ && !has_fullwidth; ++i) {
+      has_fullwidth = line[i].character.width() == 2 ||
+                      previous_line[i].character.width() == 2;
+    }
+    if (has_fullwidth) {
+      x = 0;
+    }
+
+    while (x < dimx_) {
+      // Extend the run up to the last damaged cell, absorbing short gaps.
+      int end = x + 1;
+      if (has_fullwidth) {
+        end = dimx_;
+      }
+      for (int i = end; i < dimx_ && i - end < kMaxReprintedGap; ++i) {
+        if (!SamePixel(*this, line[i], *base, previous_line[i])) {
+          end = i + 1;
+        }
+      }
+
+      MoveCursor(output, cursor_x, cursor_y, x, y);
+      bool previous_fullwidth = false;
+      for (int i = x; i < end; ++i) {
+        const Pixel& pixel = line[i];
+        if (!previous_fullwidth) {
+          UpdatePixelStyle(this, output, *previous_pixel_ref, pixel);
+          previous_pixel_ref = &pixel;
+          if (pixel.character.empty()) {
+            output += ' ';
+          } else {
+            output += pixel.character.view();
+          }
         }
+        previous_fullwidth = (pixel.character.width() == 2);
+      }
+      cursor_x = (end == dimx_) ? -1 : end;
+
+      // Skip to the next damaged cell.
+      x = end;
+      while (x < dimx_ &&
+             SamePixel(*this, line[x], *base, previous_line[x])) {
+        ++x;
       }
-      previous_fullwidth = (string_width(pixel.character) == 2);
     }
   }
 
   // Reset the style to default:
-  UpdatePixelStyle(this, ss, *previous_pixel_ref, default_pixel);
+  UpdatePixelStyle(this, output, *previous_pixel_ref, default_pixel);
 
-  return ss.str();
+  // Leave the cursor where ToString() would have left it. Moving right is
+  // clamped by the right margin of the terminal.
+  if (cursor_y != dimy_ - 1 || cursor_x >= 0) {
+    if (cursor_y != dimy_ - 1) {
+      output += "\x1B[" + std::to_string(dimy_ - 1 - cursor_y) + "B";
+    }
+    output += "\r\x1B[" + std::to_string(dimx_) + "C";  // MOVE_RIGHT
+  }
 }
 
 // Print the Screen to the terminal.
@@ -473,21 +910,21 @@ void Screen::Print() const {
 /// @return The string to print in order to reset the cursor position to the
 ///         beginning.
 std::string Screen::ResetPosition(bool clear) const {
-  std::stringstream ss;
+  std::string output;
   if (clear) {
-    ss << "\r";       // MOVE_LEFT;
-    ss << "\x1b[2K";  // CLEAR_SCREEN;
+    output += "\r";       // MOVE_LEFT;
+    output += "\x1b[2K";  // CLEAR_SCREEN;
     for (int y = 1; y < dimy_; ++y) {
-      ss << "\x1B[1A";  // MOVE_UP;
-      ss << "\x1B[2K";  // CLEAR_LINE;
+      output += "\x1B[1A";  // MOVE_UP;
+      output += "\x1B[2K";  // CLEAR_LINE;
     }
   } else {
-    ss << "\r";  // MOVE_LEFT;
-    for (int y = 1; y < dimy_; ++y) {
-      ss << "\x1B[1A";  // MOVE_UP;
+    output += "\r";  // MOVE_LEFT;
+    if (dimy_ > 1) {
+      output += "\x1B[" + std::to_string(dimy_ - 1) + "A";  // MOVE_UP;
     }
   }
-  return ss.str();
+  return output;
 }
 
 /// @brief Clear all the pixel from the screen.
@@ -508,19 +945,19 @@ void Screen::ApplyShader() {
   for (int y = 0; y < dimy_; ++y) {
     for (int x = 0; x < dimx_; ++x) {
       // Box drawing character uses exactly 3 byte.
-      Pixel& cur = pixels_[y][x];
+      Pixel& cur = pixels_[y * dimx_ + x];
       if (!ShouldAttemptAutoMerge(cur)) {
         continue;
       }
 
       if (x > 0) {
-        Pixel& left = pixels_[y][x-1];
+        Pixel& left = pixels_[y * dimx_ + x - 1];
         if (ShouldAttemptAutoMerge(left)) {
           UpgradeLeftRight(left.character, cur.character);
         }
       }
       if (y > 0) {
-        Pixel& top = pixels_[y-1][x];
+        Pixel& top = pixels_[(y - 1) * dimx_ + x];
         if (ShouldAttemptAutoMerge(top)) {
           UpgradeTopDown(top.character, cur.character);
         }
@@ -0,0 +1,167 @@
+// Copyright 2025 Arthur Sonzogni. All rights reserved.
+// Use of this source code is governed by the MIT license that can be found in
+// the LICENSE file.
+#include "ftxui/screen/screen.hpp"
+#include <gtest/gtest.h>
+#include <string>  // for allocator, string
+#include "ftxui/screen/color.hpp"     // for Color, Color::Red
+#include "ftxui/screen/terminal.hpp"  // for SetColorSupport, TrueColor
+
+namespace ftxui {
+
+namespace {
+
+Screen MakeScreen(const std::string& content, int dimx, int dimy) {
+  Screen screen(dimx, dimy);
+  for (int y = 0; y < dimy; ++y) {
+    for (int x = 0; x < dimx; ++x) {
+      screen.at(x, y) = std::string(1, content[y * dimx + x]);
+    }
+  }
+  return screen;
+}
+
+}  // namespace
+
+TEST(ScreenTest, DiffUnchanged) {
+  auto previous = MakeScreen("abcdefgh", 4, 2);
+  auto screen = MakeScreen("abcdefgh", 4, 2);
+  // Only move the cursor where ToString() would have left it.
+  EXPECT_EQ(screen.ToDiffString(previous), "\x1B[1B\r\x1B[4C");
+}
+
+TEST(ScreenTest, DiffSingleCell) {
+  auto previous = MakeScreen("abcdefghijkl", 6, 2);
+  auto screen = MakeScreen("abcdefghiXkl", 6, 2);
+  EXPECT_EQ(screen.ToDiffString(previous),
+            "\x1B[1B"     // Move to the second line.
+            "\x1B[3C"     // Move to the damaged cell.
+            "X"           // Print it.
+            "\r\x1B[6C"  // Move to the end of the screen.
+  );
+}
+
+TEST(ScreenTest, DiffMergeShortGaps) {
+  auto previous = MakeScreen("abcdefghijklmnop", 16, 1);
+  auto screen = MakeScreen("aBcDefghijklmnoP", 16, 1);
+  EXPECT_EQ(screen.ToDiffString(previous),
+            "\x1B[1C"     // Move to the first damaged cell.
+            "BcD"         // Reprint the gap in between two damaged cells.
+            "\x1B[11C"    // Jump over the long gap.
+            "P"           // Print the last cell, reaching the right margin.
+  );
+}
+
+TEST(ScreenTest, DiffStyle) {
+  Terminal::SetColorSupport(Terminal::Color::TrueColor);
+  auto previous = MakeScreen("abcdefgh", 8, 1);
+  auto screen = MakeScreen("abcdefgh", 8, 1);
+  screen.PixelAt(2, 0).foreground_color = Color::Red;
+  EXPECT_EQ(screen.ToDiffString(previous),
+            "\x1B[2C"           // Move to the damaged cell.
+            "\x1B[31m\x1B[49m"  // Set the color.
+            "c"                 // Print it.
+            "\x1B[39m\x1B[49m"  // Reset the color.
+            "\r\x1B[8C"         // Move to the end of the screen.
+  );
+}
+
+TEST(ScreenTest, DiffFallbackToFullRepaint) {
+  auto previous = MakeScreen("abcdefgh", 4, 2);
+  auto screen = MakeScreen("ABCDEfgh", 4, 2);
+  EXPECT_EQ(screen.ToDiffString(previous), screen.ToString());
+
+  // Different dimensions.
+  auto smaller = MakeScreen("abcd", 4, 1);
+  EXPECT_EQ(screen.ToDiffString(smaller), screen.ToString());
+}
+
+TEST(ScreenTest, DiffFullwidthReprintsLine) {
+  auto previous = MakeScreen("abcdefgh", 8, 1);
+  auto screen = MakeScreen("abcdefgh", 8, 1);
+  screen.at(4, 0) = "测";
+  screen.at(5, 0) = "";
+  EXPECT_EQ(screen.ToDiffString(previous), "abcd测gh");
+}
+
+TEST(ScreenTest, DiffScrollUp) {
+  auto previous = MakeScreen("aaaa" "bbbb" "cccc" "dddd" "eeee", 4, 5);
+  auto screen = MakeScreen("aaaa" "cccc" "dddd" "eeee" "ffff", 4, 5);
+  EXPECT_EQ(screen.ToDiffString(previous), screen.ToString());
+
+  std::string output;
+  screen.ToDiffString(previous, output, /*scroll_region=*/true);
+  EXPECT_EQ(output,
+            "\x1B[2;5r"  // Set the scroll region to the last four lines.
+            "\x1B[1S"    // Scroll it up by one line.
+            "\x1B[r"     // Reset the scroll region.
+            "\x1B[4B"    // Move to the exposed line.
+            "ffff"       // Print it.
+  );
+}
+
+TEST(ScreenTest, DiffScrollDown) {
+  auto previous = MakeScreen("aaaa" "bbbb" "cccc" "dddd" "zzzz", 4, 5);
+  auto screen = MakeScreen("xxxx" "yyyy" "aaaa" "bbbb" "zzzz", 4, 5);
+  std::string output;
+  screen.ToDiffString(previous, output, /*scroll_region=*/true);
+  EXPECT_EQ(output,
+            "\x1B[1;4r"  // Set the scroll region to the first four lines.
+            "\x1B[2T"    // Scroll it down by two lines.
+            "\x1B[r"     // Reset the scroll region.
+            "xxxx"       // Print the exposed lines.
+            "\x1B[1B\ryyyy"
+            "\x1B[3B\r\x1B[4C"  // Move to the end of the screen.
+  );
+}
+
+TEST(ScreenTest, DiffScrollNotWorthIt) {
+  auto previous = MakeScreen("aaaa" "bbbb" "cccc", 4, 3);
+  auto screen = MakeScreen("aaaa" "cccc" "xxxx", 4, 3);
+  std::string output;
+  screen.ToDiffString(previous, output, /*scroll_region=*/true);
+  EXPECT_EQ(output, screen.ToDiffString(previous));
+}
+
+TEST(ScreenTest, CompactStyle) {
+  Terminal::SetColorSupport(Terminal::Color::TrueColor);
+  auto screen = MakeScreen("abcd", 4, 1);
+  screen.SetCompactStyle(true);
+  screen.PixelAt(1, 0).foreground_color = Color::Red;
+  screen.PixelAt(2, 0).foreground_color = Color::Red;
+  screen.PixelAt(2, 0).bold = true;
+  screen.PixelAt(2, 0).underlined = true;
+  EXPECT_EQ(screen.ToString(),
+            "a"
+            "\x1B[31m"   // Only the foreground color changed.
+            "b"
+            "\x1B[1;4m"  // Set the new attributes.
+            "c"
+            "\x1B[0m"    // Resetting is shorter than unsetting each one.
+            "d"          // Already in the default style, nothing to reset.
+  );
+}
+
+TEST(ScreenTest, GlyphStorage) {
+  Screen screen(2, 1);
+  screen.at(0, 0) = "a";
+  // A grapheme cluster too long to be stored inline.
+  const std::string family = "👨\u200D👩\u200D👧";
+  screen.at(1, 0) = family;
+  EXPECT_EQ(screen.at(0, 0), "a");
+  EXPECT_EQ(screen.at(1, 0), family);
+  EXPECT_EQ(Glyph(family), Glyph(family));
+  EXPECT_NE(Glyph(family), Glyph("a"));
+  EXPECT_EQ(screen.ToString(), "a" + family);
+}
+
+TEST(ScreenTest, GlyphWidth) {
+  EXPECT_EQ(Glyph().width(), 0);
+  EXPECT_EQ(Glyph("a").width(), 1);
+  EXPECT_EQ(Glyph("\t").width(), 0);
+  EXPECT_EQ(Glyph("é").width(), 1);
+  EXPECT_EQ(Glyph("测").width(), 2);
+  EXPECT_EQ(Glyph("abcdefghijkl").width(), 3);
+}
+
+}  // namespace ftxui
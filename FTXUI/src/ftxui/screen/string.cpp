@@ -1331,6 +1331,14 @@ int string_width(const std::string& input) {
   int width = 0;
   size_t start = 0;
   while (start < input.size()) {
+    // Quick path: ASCII characters.
+    const auto byte = static_cast<uint8_t>(input[start]);
+    if (byte < 0x80) {  // NOLINT
+      width += IsControl(byte) ? 0 : 1;
+      start++;
+      continue;
+    }
+
     uint32_t codepoint = 0;
     if (!EatCodePoint(input, start, &start, &codepoint)) {
       continue;
@@ -1360,6 +1368,16 @@ std::vector<std::string> Utf8ToGlyphs(const std::string& input) {
   size_t start = 0;
   size_t end = 0;
   while (start < input.size()) {
+    // Quick path: ASCII characters are neither combining nor fullwidth.
+    const auto byte = static_cast<uint8_t>(input[start]);
+    if (byte < 0x80) {  // NOLINT
+      if (!IsControl(byte)) {
+        out.emplace_back(1, input[start]);
+      }
+      start++;
+      continue;
+    }
+
     uint32_t codepoint = 0;
     if (!EatCodePoint(input, start, &end, &codepoint)) {
       start = end;
@@ -0,0 +1,54 @@
+#ifndef HEX_ADDRESS_MAP_HPP
+#define HEX_ADDRESS_MAP_HPP
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Bytes of the file loaded at a virtual address.
+struct Mapping {
+    uint64_t offset;
+    uint64_t address;
+    uint64_t size;
+};
+
+// File offsets to virtual addresses and back, from the segments of an
+// executable or a core dump. Mappings may overlap: where they do, the first
+// one added wins. They are cut into disjoint intervals sorted both ways, so
+// that a lookup is a binary search even with thousands of segments.
+class AddressMap {
+public:
+    void Add(uint64_t offset, uint64_t address, uint64_t size);
+
+    // Build the intervals, once every mapping is added.
+    void Finish();
+
+    bool empty() const { return mappings_.empty(); }
+
+    // One past the highest address mapped.
+    uint64_t end_address() const { return end_address_; }
+
+    // The address the byte at offset is loaded at, if it is loaded.
+    std::optional<uint64_t> AddressOf(uint64_t offset) const;
+
+    // The offset of the byte loaded at address, if it comes from the file.
+    std::optional<uint64_t> OffsetOf(uint64_t address) const;
+
+private:
+    // [start, end) in offsets or in addresses, covered by a mapping
+    struct Interval {
+        uint64_t start;
+        uint64_t end;
+        uint32_t mapping;
+    };
+
+    std::vector<Interval> Flatten(bool by_address) const;
+    static const Interval* Lookup(const std::vector<Interval>& intervals, uint64_t value);
+
+    std::vector<Mapping> mappings_;
+    std::vector<Interval> by_offset_;
+    std::vector<Interval> by_address_;
+    uint64_t end_address_ = 0;
+};
+
+#endif  // HEX_ADDRESS_MAP_HPP
@@ -0,0 +1,51 @@
+#ifndef HEX_BYTE_READER_HPP
+#define HEX_BYTE_READER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Reads integer fields in place, in the byte order of the file, so that
+// format parsers never copy the headers they walk. Callers check Has() first.
+class ByteReader {
+public:
+    explicit ByteReader(std::string_view data, bool big_endian = false)
+        : data_(data), big_endian_(big_endian) {}
+
+    size_t size() const { return data_.size(); }
+
+    bool Has(uint64_t offset, uint64_t size) const {
+        return offset <= data_.size() && size <= data_.size() - offset;
+    }
+
+    uint64_t Read(uint64_t offset, int width) const {
+        uint64_t value = 0;
+        for (int i = 0; i < width; ++i) {
+            uint64_t byte = static_cast<unsigned char>(data_[offset + i]);
+            value |= byte << (8 * (big_endian_ ? width - 1 - i : i));
+        }
+        return value;
+    }
+
+    uint8_t U8(uint64_t offset) const { return static_cast<uint8_t>(data_[offset]); }
+    uint16_t U16(uint64_t offset) const { return static_cast<uint16_t>(Read(offset, 2)); }
+    uint32_t U32(uint64_t offset) const { return static_cast<uint32_t>(Read(offset, 4)); }
+    uint64_t U64(uint64_t offset) const { return Read(offset, 8); }
+
+    // The NUL-terminated string at offset, not going past limit.
+    std::string String(uint64_t offset, uint64_t limit) const {
+        limit = std::min<uint64_t>(limit, data_.size());
+        std::string str;
+        for (uint64_t i = offset; i < limit && data_[i] != '\0'; ++i) {
+            str += data_[i];
+        }
+        return str;
+    }
+
+private:
+    std::string_view data_;
+    bool big_endian_;
+};
+
+#endif  // HEX_BYTE_READER_HPP
@@ -0,0 +1,16 @@
+#ifndef HEX_CRC32_HPP
+#define HEX_CRC32_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// The CRC-32 of PNG, ZIP and gzip (reflected polynomial 0xEDB88320), as
+// zlib's crc32(): pass the CRC of the previous bytes to continue it.
+uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0);
+
+// The CRC of the concatenation of two blocks, from the CRC of each one and
+// the size of the second, as zlib's crc32_combine(). Blocks can be checked
+// in parallel this way.
+uint32_t Crc32Combine(uint32_t crc1, uint32_t crc2, uint64_t size2);
+
+#endif  // HEX_CRC32_HPP
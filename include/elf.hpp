@@ -0,0 +1,89 @@
+#ifndef HEX_ELF_HPP
+#define HEX_ELF_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "address_map.hpp"
+#include "format.hpp"
+#include "region.hpp"
+#include "symbol_index.hpp"
+
+// The fields of the ELF file header, widened to the 64-bit layout and
+// converted to the host byte order.
+struct ElfHeader {
+    bool is_64;
+    bool big_endian;
+    uint16_t type;
+    uint16_t machine;
+    uint64_t entry;
+    uint64_t phoff;
+    uint64_t shoff;
+    uint16_t ehsize;
+    uint16_t phentsize;
+    uint16_t shentsize;
+    // The real counts and index, after the PN_XNUM / SHN_XINDEX escapes.
+    uint32_t phnum;
+    uint32_t shnum;
+    uint32_t shstrndx;
+};
+
+struct ElfSegment {
+    uint32_t type;
+    uint32_t flags;
+    uint64_t offset;
+    uint64_t vaddr;
+    uint64_t filesz;
+    uint64_t memsz;
+};
+
+struct ElfSection {
+    std::string name;
+    uint32_t type;
+    uint64_t flags;
+    uint64_t addr;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t link;
+    uint32_t info;
+    uint64_t entsize;
+};
+
+// Everything the header tables describe. Entries pointing past the end of the
+// file are kept, their regions are clipped to the file.
+struct ElfLayout {
+    ElfHeader header;
+    std::vector<ElfSegment> segments;
+    std::vector<ElfSection> sections;
+    // The functions and objects of .symtab and .dynsym, at their file offsets
+    SymbolIndex symbols;
+    // The PT_LOAD segments
+    AddressMap addresses;
+    RegionMap regions;
+};
+
+bool IsElf(std::string_view data);
+
+// Read the file header only. Returns nothing if the data isn't a 32 or 64-bit
+// ELF file, or the header is truncated.
+std::optional<ElfHeader> ParseElfHeader(std::string_view data);
+
+// Read the program and section header tables. Every read is bounds-checked:
+// a truncated or corrupted file gives the entries that could be read. Gives
+// nothing once cancel is set.
+std::optional<ElfLayout> ParseElfLayout(std::string_view data, const std::atomic<bool>* cancel = nullptr);
+
+// The program header table only, so that segments can be shown before the
+// section table and its names are read.
+std::optional<ElfLayout> ParseElfSegments(std::string_view data, const std::atomic<bool>* cancel = nullptr);
+
+// An ELF file parsed off the UI thread. Detecting the format costs a check of
+// the magic. The analysis reads the program headers first, then the sections
+// and symbols, and stops when the bytes change under it.
+using ElfFile = LazyFormat<ElfLayout, ParseElfLayout, ParseElfSegments>;
+
+#endif  // HEX_ELF_HPP
@@ -0,0 +1,190 @@
+#ifndef HEX_FORMAT_HPP
+#define HEX_FORMAT_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "region.hpp"
+
+class AddressMap;
+class SymbolIndex;
+
+// A file format detected in the loaded bytes. Its regions are analyzed off the
+// UI thread, coarse ones first, in a run that an edit cancels.
+class Format {
+public:
+    explicit Format(std::string name) : name_(std::move(name)) {}
+    virtual ~Format() = default;
+
+    const std::string& name() const { return name_; }
+
+    // The regions of data, parsing them if needed. nullptr if the bytes turn
+    // out not to be in this format.
+    virtual const RegionMap* Regions(std::string_view data) = 0;
+
+    // The bytes changed: parse them again on the next request.
+    virtual void Invalidate() = 0;
+
+    // The symbols of data, parsing them if needed. nullptr if the format has
+    // no symbol table.
+    virtual const SymbolIndex* Symbols(std::string_view) { return nullptr; }
+
+    // Where the bytes of data are loaded in memory, parsing them if needed.
+    // nullptr if the format isn't loaded at fixed addresses.
+    virtual const AddressMap* Addresses(std::string_view) { return nullptr; }
+
+    // Receives the regions known after each step of an analysis, from 1 to
+    // AnalysisSteps().
+    using PublishRegions = std::function<void(const RegionMap& regions, int step)>;
+
+    // How many times Analyze() publishes regions.
+    virtual int AnalysisSteps() const { return 1; }
+
+    // Parse the regions of data in steps, the coarse ones first, for a worker
+    // thread. data must not change until it returns. Stops between steps once
+    // cancel is set.
+    virtual void Analyze(std::string_view data, const PublishRegions& publish,
+                         const std::atomic<bool>& cancel);
+
+private:
+    std::string name_;
+};
+
+// Whether a parser given this flag should stop: the analysis it runs for was
+// cancelled. Parsers taking one check it in their loops over large tables.
+inline bool Cancelled(const std::atomic<bool>* cancel) {
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+// A format whose parser gives a layout holding its regions, kept until the
+// bytes change. A cheaper parser for the coarse regions, if given, is the
+// first step of the analysis. Parsers taking a cancel flag after the data
+// are given the one of the analysis.
+template <typename LayoutType, auto Parse, auto ParseCoarse = nullptr>
+class LazyFormat : public Format {
+public:
+    using Format::Format;
+
+    static constexpr bool has_coarse_step = !std::is_same_v<decltype(ParseCoarse), std::nullptr_t>;
+
+    int AnalysisSteps() const override {
+        if constexpr (has_coarse_step) {
+            return 2;
+        }
+        return 1;
+    }
+
+    void Analyze(std::string_view data, const PublishRegions& publish,
+                 const std::atomic<bool>& cancel) override {
+        if constexpr (has_coarse_step) {
+            auto coarse = Run<ParseCoarse>(data, &cancel);
+            if (cancel) {
+                return;
+            }
+            if (coarse) {
+                publish(coarse->regions, 1);
+            }
+        }
+        if (!parsed_) {
+            layout_ = Run<Parse>(data, &cancel);
+            // A parse cut short isn't kept.
+            if (cancel) {
+                layout_.reset();
+                return;
+            }
+            parsed_ = true;
+        }
+        if (layout_) {
+            publish(layout_->regions, AnalysisSteps());
+        }
+    }
+
+    const LayoutType* Layout(std::string_view data) {
+        if (!parsed_) {
+            layout_ = Run<Parse>(data, nullptr);
+            parsed_ = true;
+        }
+        return layout_ ? &*layout_ : nullptr;
+    }
+
+    const RegionMap* Regions(std::string_view data) override {
+        const LayoutType* layout = Layout(data);
+        return layout ? &layout->regions : nullptr;
+    }
+
+    const SymbolIndex* Symbols(std::string_view data) override {
+        if constexpr (requires(const LayoutType& layout) { layout.symbols; }) {
+            const LayoutType* layout = Layout(data);
+            return layout ? &layout->symbols : nullptr;
+        }
+        return nullptr;
+    }
+
+    const AddressMap* Addresses(std::string_view data) override {
+        if constexpr (requires(const LayoutType& layout) { layout.addresses; }) {
+            const LayoutType* layout = Layout(data);
+            return layout ? &layout->addresses : nullptr;
+        }
+        return nullptr;
+    }
+
+    void Invalidate() override {
+        parsed_ = false;
+        layout_.reset();
+    }
+
+private:
+    template <auto ParseFunction>
+    static std::optional<LayoutType> Run(std::string_view data, const std::atomic<bool>* cancel) {
+        if constexpr (std::is_invocable_v<decltype(ParseFunction), std::string_view, const std::atomic<bool>*>) {
+            return ParseFunction(data, cancel);
+        } else {
+            return ParseFunction(data);
+        }
+    }
+
+    bool parsed_ = false;
+    std::optional<LayoutType> layout_;
+};
+
+struct FormatDetector {
+    std::string name;
+    // The magic number, and where it is in the file.
+    std::string magic;
+    size_t magic_offset = 0;
+    // Further checks once the magic matched, or nullptr.
+    bool (*match)(std::string_view data) = nullptr;
+    std::unique_ptr<Format> (*create)(const std::string& name) = nullptr;
+};
+
+// Detectors keyed by the first byte of their magic number, so that a file
+// is only checked against the few formats starting with the same byte.
+// Magic numbers found further in the file are checked for every file.
+class FormatRegistry {
+public:
+    void Register(FormatDetector detector);
+
+    // The format of data, from the first matching detector. Magic numbers at
+    // the start of the file are tried first, each group in registration
+    // order. nullptr if none matched.
+    std::unique_ptr<Format> Detect(std::string_view data) const;
+
+    // The formats the viewer knows.
+    static const FormatRegistry& Default();
+
+private:
+    static bool Matches(const FormatDetector& detector, std::string_view data);
+
+    std::array<std::vector<FormatDetector>, 256> by_first_byte_;
+    std::vector<FormatDetector> at_offset_;
+};
+
+#endif  // HEX_FORMAT_HPP
@@ -0,0 +1,38 @@
+#ifndef HEX_GIF_HPP
+#define HEX_GIF_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "format.hpp"
+#include "region.hpp"
+
+struct GifBlock {
+    uint64_t offset;
+    uint64_t size;
+    // "image descriptor", "graphic control extension"...
+    std::string name;
+};
+
+struct GifLayout {
+    uint16_t width = 0;
+    uint16_t height = 0;
+    size_t images = 0;
+    std::vector<GifBlock> blocks;
+    // The blocks end before the trailer.
+    bool truncated = false;
+    RegionMap regions;
+};
+
+bool IsGif(std::string_view data);
+
+// Walk the blocks up to the trailer. Image data and extensions are chains of
+// sub-blocks: they are skipped by their size bytes, not decoded.
+std::optional<GifLayout> ParseGifLayout(std::string_view data);
+
+using GifFile = LazyFormat<GifLayout, ParseGifLayout>;
+
+#endif  // HEX_GIF_HPP
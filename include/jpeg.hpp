@@ -0,0 +1,37 @@
+#ifndef HEX_JPEG_HPP
+#define HEX_JPEG_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "format.hpp"
+#include "region.hpp"
+
+struct JpegSegment {
+    uint64_t offset;  // Of the marker, fill bytes included
+    uint8_t marker;
+    // Marker and payload. Entropy-coded data after a SOS segment is not
+    // part of it.
+    uint64_t size;
+    // The segment goes past the end of the file.
+    bool truncated;
+};
+
+struct JpegLayout {
+    std::vector<JpegSegment> segments;
+    size_t scans = 0;
+    RegionMap regions;
+};
+
+bool IsJpeg(std::string_view data);
+
+// Walk the marker segments from SOI to EOI, skipping each by its length.
+// Entropy-coded scan data has no length: it is skipped to the next marker
+// with memchr, not decoded.
+std::optional<JpegLayout> ParseJpegLayout(std::string_view data);
+
+using JpegFile = LazyFormat<JpegLayout, ParseJpegLayout>;
+
+#endif  // HEX_JPEG_HPP
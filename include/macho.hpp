@@ -0,0 +1,60 @@
+#ifndef HEX_MACHO_HPP
+#define HEX_MACHO_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "format.hpp"
+#include "region.hpp"
+
+struct MachOSegment {
+    std::string name;
+    uint64_t vmaddr;
+    uint64_t vmsize;
+    uint64_t fileoff;
+    uint64_t filesize;
+    uint32_t initprot;
+};
+
+struct MachOSection {
+    std::string segment;
+    std::string name;
+    uint64_t addr;
+    uint64_t size;
+    uint32_t offset;
+    uint32_t flags;
+};
+
+// A Mach-O image: the whole file, or one architecture of a fat binary. File
+// offsets in the load commands are relative to the start of the slice.
+struct MachOSlice {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t cputype;
+    bool is_64;
+    bool big_endian;
+    uint32_t filetype;
+    std::vector<MachOSegment> segments;
+    std::vector<MachOSection> sections;
+};
+
+struct MachOLayout {
+    bool fat = false;
+    std::vector<MachOSlice> slices;
+    RegionMap regions;
+};
+
+// Thin Mach-O, 32 or 64-bit, in either byte order, or a fat binary.
+bool IsMachO(std::string_view data);
+
+// Walk the fat arch table, and the header and load commands of each slice.
+// Walks stop at the first entry past the end of its slice, so that a
+// truncated file costs no more than what it holds.
+std::optional<MachOLayout> ParseMachOLayout(std::string_view data);
+
+using MachOFile = LazyFormat<MachOLayout, ParseMachOLayout>;
+
+#endif  // HEX_MACHO_HPP
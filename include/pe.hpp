@@ -0,0 +1,78 @@
+#ifndef HEX_PE_HPP
+#define HEX_PE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "address_map.hpp"
+#include "format.hpp"
+#include "region.hpp"
+
+// The fields of the COFF and optional headers the viewer uses. Only set when
+// the MZ header points to a PE signature.
+struct PeHeader {
+    uint64_t pe_offset;
+    uint16_t machine;
+    uint16_t section_count;
+    uint16_t optional_header_size;
+    uint16_t characteristics;
+    // PE32+ (64-bit) optional header
+    bool is_64;
+    uint32_t entry_point;
+    uint64_t image_base;
+    uint32_t size_of_headers;
+};
+
+struct PeSection {
+    std::string name;
+    uint32_t virtual_size;
+    uint32_t virtual_address;
+    uint32_t raw_size;
+    uint32_t raw_offset;
+    uint32_t characteristics;
+};
+
+struct PeDataDirectory {
+    uint32_t rva;
+    uint32_t size;
+    // Where the directory is in the file, if it is.
+    std::optional<uint64_t> offset;
+};
+
+struct PeImport {
+    std::string dll;
+    uint64_t descriptor_offset;
+};
+
+// Everything the headers describe. A file with an MZ header but no PE
+// signature is a DOS program: only its header and body are set.
+struct PeLayout {
+    std::optional<PeHeader> header;
+    std::vector<PeSection> sections;
+    std::vector<PeDataDirectory> directories;
+    std::vector<PeImport> imports;
+    std::string export_name;
+    // The headers and sections, at their virtual addresses
+    AddressMap addresses;
+    RegionMap regions;
+};
+
+bool IsMz(std::string_view data);
+
+// Walk the headers, section table and data directories in place. Every read
+// is bounds-checked: a truncated or corrupted file gives the entries that
+// could be read.
+std::optional<PeLayout> ParsePeLayout(std::string_view data);
+
+// The headers and sections, without following the data directories.
+std::optional<PeLayout> ParsePeSections(std::string_view data);
+
+// The file offset of a relative virtual address, if it is backed by the file.
+std::optional<uint64_t> PeRvaToOffset(const PeLayout& layout, uint64_t rva);
+
+using PeFile = LazyFormat<PeLayout, ParsePeLayout, ParsePeSections>;
+
+#endif  // HEX_PE_HPP
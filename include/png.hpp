@@ -0,0 +1,42 @@
+#ifndef HEX_PNG_HPP
+#define HEX_PNG_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "format.hpp"
+#include "region.hpp"
+
+struct PngChunk {
+    uint64_t offset;  // Of the length field
+    uint32_t length;  // Of the data
+    std::string type;
+    bool crc_ok;
+    // The chunk goes past the end of the file.
+    bool truncated;
+};
+
+struct PngLayout {
+    std::vector<PngChunk> chunks;
+    size_t corrupt_chunks = 0;
+    RegionMap regions;
+};
+
+bool IsPng(std::string_view data);
+
+// Walk every chunk and verify its CRC. Large images are verified on several
+// threads. Corrupt and truncated chunks are marked with RegionKind::Corrupt.
+// Gives nothing once cancel is set.
+std::optional<PngLayout> ParsePngLayout(std::string_view data, const std::atomic<bool>* cancel = nullptr);
+
+// Walk the chunks without reading their data: CRCs are not verified, only
+// truncated chunks are marked.
+std::optional<PngLayout> ParsePngChunks(std::string_view data, const std::atomic<bool>* cancel = nullptr);
+
+using PngFile = LazyFormat<PngLayout, ParsePngLayout, ParsePngChunks>;
+
+#endif  // HEX_PNG_HPP
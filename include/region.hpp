@@ -0,0 +1,64 @@
+#ifndef HEX_REGION_HPP
+#define HEX_REGION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// What a region of a file holds, used to pick its color.
+enum class RegionKind {
+    Header,    // File and format headers
+    Table,     // Header tables, directories, indexes
+    Code,      // Executable bytes
+    Data,      // Writable data
+    ReadOnly,  // Loaded, read-only data
+    Symbols,   // Symbol tables
+    Strings,   // String tables
+    Checksum,  // CRCs and other check values
+    Corrupt,   // Failed verification, or cut by the end of the file
+    Other      // Anything else worth a name: notes, debug info, ...
+};
+
+// A named, inclusive byte range of the file, like PartitionInfo.
+struct Region {
+    size_t start;
+    size_t end;
+    std::string name;
+    RegionKind kind;
+};
+
+// Non-overlapping regions, keyed by their first byte. Formats nest regions
+// (sections inside segments, headers inside the first segment), so the
+// regions are painted from the outermost to the innermost one: a region
+// painted later hides the part of the previous ones it covers.
+class RegionMap {
+public:
+    void Paint(const Region& region);
+    // Paint from the largest to the smallest region, so that the innermost
+    // names are kept. Equal sizes keep their order: the later is painted last.
+    void PaintNested(std::vector<Region> regions);
+
+    // The region covering pos, or nullptr.
+    const Region* Find(size_t pos) const;
+    // The first region starting after pos, or nullptr.
+    const Region* Next(size_t pos) const;
+    // The last region starting before pos, or nullptr.
+    const Region* Previous(size_t pos) const;
+
+    bool empty() const { return regions_.empty(); }
+    size_t size() const { return regions_.size(); }
+    std::map<size_t, Region>::const_iterator begin() const { return regions_.begin(); }
+    std::map<size_t, Region>::const_iterator end() const { return regions_.end(); }
+
+private:
+    std::map<size_t, Region> regions_;
+};
+
+// The region of [offset, offset + size) inside the file, if any byte of it is.
+std::optional<Region> ClippedRegion(uint64_t offset, uint64_t size, size_t file_size,
+                                    std::string name, RegionKind kind);
+
+#endif  // HEX_REGION_HPP
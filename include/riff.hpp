@@ -0,0 +1,43 @@
+#ifndef HEX_RIFF_HPP
+#define HEX_RIFF_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "format.hpp"
+#include "region.hpp"
+
+struct RiffChunk {
+    uint64_t offset;  // Of its header
+    std::string id;
+    // Of the data. RF64 files give the sizes of large chunks in a ds64 chunk.
+    uint64_t size;
+    // RIFF and LIST chunks hold a list of chunks, after their type.
+    std::string list_type;
+    int depth;
+    bool truncated;
+};
+
+// WAV, AVI or WebP: the form type of the first RIFF chunk. AVI files larger
+// than 1 GiB continue in AVIX chunks after it.
+struct RiffLayout {
+    std::string form;
+    std::vector<RiffChunk> chunks;
+    RegionMap regions;
+};
+
+bool IsRiff(std::string_view data);
+
+// "WAVE", "AVI ", "WEBP"...
+std::string_view RiffForm(std::string_view data);
+
+// Walk the chunk tree, skipping each chunk by its size. The frames of an AVI
+// movi list are not walked: the list is a single region.
+std::optional<RiffLayout> ParseRiffLayout(std::string_view data);
+
+using RiffFile = LazyFormat<RiffLayout, ParseRiffLayout>;
+
+#endif  // HEX_RIFF_HPP
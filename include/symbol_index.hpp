@@ -0,0 +1,58 @@
+#ifndef HEX_SYMBOL_INDEX_HPP
+#define HEX_SYMBOL_INDEX_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct Symbol {
+    std::string_view name;
+    // Where its bytes are in the file
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Symbol names to file offsets. The names are copied into one buffer and the
+// entries only hold fixed-size offsets into it, so that a binary with
+// millions of symbols costs a few allocations.
+class SymbolIndex {
+public:
+    void Add(std::string_view name, uint64_t offset, uint64_t size);
+
+    // Build the hash table and the sorted names, once every symbol is added.
+    void Finish();
+
+    bool empty() const { return entries_.empty(); }
+    size_t size() const { return entries_.size(); }
+
+    // The symbol named name, from the hash table. With several symbols of the
+    // same name, the first one added.
+    std::optional<Symbol> Find(std::string_view name) const;
+
+    // Up to limit symbols whose name starts with prefix, in name order, from
+    // a binary search in the sorted names.
+    std::vector<Symbol> Complete(std::string_view prefix, size_t limit) const;
+
+private:
+    struct Entry {
+        uint32_t name;
+        uint32_t name_size;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    std::string_view Name(const Entry& entry) const;
+    Symbol ToSymbol(const Entry& entry) const;
+
+    std::string names_;
+    std::vector<Entry> entries_;
+    // Open addressing: entry index + 1, 0 for an empty slot. The size is a
+    // power of two at least twice the number of entries.
+    std::vector<uint32_t> slots_;
+    // Entry indexes in name order.
+    std::vector<uint32_t> sorted_;
+};
+
+#endif  // HEX_SYMBOL_INDEX_HPP
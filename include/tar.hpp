@@ -0,0 +1,41 @@
+#ifndef HEX_TAR_HPP
+#define HEX_TAR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "format.hpp"
+#include "region.hpp"
+
+struct TarEntry {
+    // After the GNU long name and pax extended headers before it, if any.
+    std::string name;
+    char type;
+    uint64_t size;
+    // Of its first header, extended ones included, and of its data.
+    uint64_t header_offset;
+    uint64_t data_offset;
+};
+
+struct TarLayout {
+    std::vector<TarEntry> entries;
+    // The walk stopped at a header whose checksum doesn't match.
+    bool corrupt = false;
+    RegionMap regions;
+};
+
+// A POSIX or GNU tar header, "ustar" magic and checksum included.
+bool IsTar(std::string_view data);
+
+// Step through the 512-byte headers. The data of an entry is skipped by its
+// size, only the extended headers holding names and sizes are read: mapping a
+// large archive reads its headers only. Gives nothing once cancel is set.
+std::optional<TarLayout> ParseTarLayout(std::string_view data, const std::atomic<bool>* cancel = nullptr);
+
+using TarFile = LazyFormat<TarLayout, ParseTarLayout>;
+
+#endif  // HEX_TAR_HPP
@@ -0,0 +1,57 @@
+#ifndef HEX_ZIP_HPP
+#define HEX_ZIP_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "format.hpp"
+#include "region.hpp"
+
+struct ZipEntry {
+    std::string name;
+    uint16_t flags;
+    uint16_t method;
+    uint32_t crc;
+    // After the ZIP64 extra field, if any.
+    uint64_t compressed_size;
+    uint64_t uncompressed_size;
+    // File offsets of its central directory record, if read from it, and of
+    // its local header.
+    std::optional<uint64_t> central_offset;
+    uint64_t local_offset;
+};
+
+// A ZIP archive (JAR, APK, OCI layer...). Offsets in the archive are relative
+// to its first byte: data prepended to it (a self-extracting stub or a
+// launcher script) is skipped.
+struct ZipLayout {
+    // Where the end of central directory record is, if found. Without it, the
+    // entries are walked from the local header at the start of the file.
+    std::optional<uint64_t> end_offset;
+    bool zip64 = false;
+    uint64_t prefix_size = 0;
+    uint64_t central_directory_offset = 0;
+    uint64_t central_directory_size = 0;
+    std::vector<ZipEntry> entries;
+    RegionMap regions;
+};
+
+// Starts with a local header, or ends with an end of central directory record
+// (found by scanning back from the end over the archive comment).
+bool IsZip(std::string_view data);
+
+// Walk the central directory, then the local header of each entry. Entry data
+// is not read. Gives nothing once cancel is set.
+std::optional<ZipLayout> ParseZipLayout(std::string_view data, const std::atomic<bool>* cancel = nullptr);
+
+// The central directory only: each entry is a single region up to the next
+// one, before its local header is read.
+std::optional<ZipLayout> ParseZipDirectory(std::string_view data, const std::atomic<bool>* cancel = nullptr);
+
+using ZipFile = LazyFormat<ZipLayout, ParseZipLayout, ParseZipDirectory>;
+
+#endif  // HEX_ZIP_HPP
@@ -0,0 +1,97 @@
+#include "address_map.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+void AddressMap::Add(uint64_t offset, uint64_t address, uint64_t size) {
+    // Intervals hold 32-bit mapping indexes, and their ends must not wrap.
+    const uint64_t limit = std::numeric_limits<uint64_t>::max() - std::max(offset, address);
+    size = std::min(size, limit);
+    if (size == 0 || mappings_.size() == std::numeric_limits<uint32_t>::max()) {
+        return;
+    }
+    mappings_.push_back({ offset, address, size });
+}
+
+void AddressMap::Finish() {
+    by_offset_ = Flatten(false);
+    by_address_ = Flatten(true);
+    end_address_ = by_address_.empty() ? 0 : by_address_.back().end;
+}
+
+// Sweep the boundaries of the mappings in order, keeping the ones covering
+// the current interval in a heap: its top is the first one added.
+std::vector<AddressMap::Interval> AddressMap::Flatten(bool by_address) const {
+    auto start = [&](uint32_t index) {
+        return by_address ? mappings_[index].address : mappings_[index].offset;
+    };
+    auto end = [&](uint32_t index) { return start(index) + mappings_[index].size; };
+
+    std::vector<uint32_t> order(mappings_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return start(a) < start(b); });
+
+    std::vector<uint64_t> bounds;
+    bounds.reserve(mappings_.size() * 2);
+    for (uint32_t index : order) {
+        bounds.push_back(start(index));
+        bounds.push_back(end(index));
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    std::vector<Interval> intervals;
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> active;
+    size_t next = 0;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        const uint64_t low = bounds[i];
+        const uint64_t high = bounds[i + 1];
+        while (next < order.size() && start(order[next]) <= low) {
+            active.push(order[next++]);
+        }
+        // Mappings ending before are only dropped once they are on top.
+        while (!active.empty() && end(active.top()) <= low) {
+            active.pop();
+        }
+        if (active.empty()) {
+            continue;
+        }
+        if (!intervals.empty() && intervals.back().mapping == active.top() && intervals.back().end == low) {
+            intervals.back().end = high;
+        } else {
+            intervals.push_back({ low, high, active.top() });
+        }
+    }
+    return intervals;
+}
+
+const AddressMap::Interval* AddressMap::Lookup(const std::vector<Interval>& intervals, uint64_t value) {
+    auto it = std::upper_bound(intervals.begin(), intervals.end(), value, [](uint64_t value, const Interval& interval) {
+        return value < interval.start;
+    });
+    if (it == intervals.begin() || value >= (--it)->end) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+std::optional<uint64_t> AddressMap::AddressOf(uint64_t offset) const {
+    const Interval* interval = Lookup(by_offset_, offset);
+    if (!interval) {
+        return std::nullopt;
+    }
+    const Mapping& mapping = mappings_[interval->mapping];
+    return mapping.address + (offset - mapping.offset);
+}
+
+std::optional<uint64_t> AddressMap::OffsetOf(uint64_t address) const {
+    const Interval* interval = Lookup(by_address_, address);
+    if (!interval) {
+        return std::nullopt;
+    }
+    const Mapping& mapping = mappings_[interval->mapping];
+    return mapping.offset + (address - mapping.address);
+}
@@ -0,0 +1,97 @@
+#include "crc32.hpp"
+
+#include <array>
+
+namespace {
+
+const uint32_t crc32_polynomial = 0xedb88320;
+
+// Slicing-by-8: tables[k][b] is the CRC of byte b followed by k zero bytes,
+// so eight bytes are folded per step with eight independent lookups.
+using Crc32Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+const Crc32Tables crc32_tables = [] {
+    Crc32Tables tables;
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ crc32_polynomial : crc >> 1;
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (size_t k = 1; k < tables.size(); ++k) {
+            uint32_t previous = tables[k - 1][i];
+            tables[k][i] = (previous >> 8) ^ tables[0][previous & 0xff];
+        }
+    }
+    return tables;
+}();
+
+// Compilers turn this into a single load on little-endian hosts.
+uint32_t Load32(const unsigned char* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+// a * b modulo the polynomial, both reflected.
+uint32_t MultiplyModP(uint32_t a, uint32_t b) {
+    uint32_t m = 1u << 31;
+    uint32_t product = 0;
+    for (;;) {
+        if (a & m) {
+            product ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ crc32_polynomial : b >> 1;
+    }
+    return product;
+}
+
+// x^(2^k) modulo the polynomial.
+const std::array<uint32_t, 32> x2n_table = [] {
+    std::array<uint32_t, 32> table;
+    uint32_t p = 1u << 30;  // x^1
+    table[0] = p;
+    for (size_t n = 1; n < table.size(); ++n) {
+        table[n] = p = MultiplyModP(p, p);
+    }
+    return table;
+}();
+
+// x^(8 * size) modulo the polynomial: appending size zero bytes.
+uint32_t ShiftModP(uint64_t size) {
+    uint32_t p = 1u << 31;  // x^0
+    for (size_t k = 3; size != 0; size >>= 1, ++k) {
+        if (size & 1) {
+            p = MultiplyModP(x2n_table[k & 31], p);
+        }
+    }
+    return p;
+}
+
+}  // namespace
+
+uint32_t Crc32(const void* data, size_t size, uint32_t crc) {
+    const Crc32Tables& t = crc32_tables;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        uint32_t one = Load32(p) ^ crc;
+        uint32_t two = Load32(p + 4);
+        crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff] ^
+              t[5][(one >> 16) & 0xff] ^ t[4][one >> 24] ^
+              t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff] ^
+              t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+    }
+    for (; size != 0; --size, ++p) {
+        crc = t[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t Crc32Combine(uint32_t crc1, uint32_t crc2, uint64_t size2) {
+    return MultiplyModP(ShiftModP(size2), crc1) ^ crc2;
+}
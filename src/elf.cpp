@@ -0,0 +1,417 @@
+#include "elf.hpp"
+
+#include "byte_reader.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+const unsigned char elf_magic[] = { 0x7f, 'E', 'L', 'F' };
+
+// e_ident fields
+const size_t ei_class = 4;
+const size_t ei_data = 5;
+const unsigned char elf_class_32 = 1;
+const unsigned char elf_class_64 = 2;
+const unsigned char elf_data_lsb = 1;
+const unsigned char elf_data_msb = 2;
+
+// Counts and indexes too large for the header are stored in section 0.
+const uint16_t pn_xnum = 0xffff;
+const uint16_t shn_xindex = 0xffff;
+
+// Segment types
+const uint32_t pt_null = 0;
+const uint32_t pt_load = 1;
+const uint32_t pt_phdr = 6;
+const uint32_t pf_x = 0x1;
+const uint32_t pf_w = 0x2;
+
+// Section types and flags
+const uint32_t sht_null = 0;
+const uint32_t sht_symtab = 2;
+const uint32_t sht_strtab = 3;
+const uint32_t sht_nobits = 8;
+const uint32_t sht_dynsym = 11;
+const uint64_t shf_write = 0x1;
+const uint64_t shf_alloc = 0x2;
+const uint64_t shf_execinstr = 0x4;
+
+// Symbol types and section indexes
+const uint8_t stt_notype = 0;
+const uint8_t stt_object = 1;
+const uint8_t stt_func = 2;
+const uint8_t stt_gnu_ifunc = 10;
+const uint16_t shn_undef = 0;
+const uint16_t shn_loreserve = 0xff00;
+
+// File types
+const uint16_t et_rel = 1;
+
+// ELF names its fields after their width, and addresses, offsets and sizes
+// take 4 bytes in 32-bit files, 8 in 64-bit ones.
+class ElfReader : public ByteReader {
+public:
+    ElfReader(std::string_view data, bool big_endian, bool is_64)
+        : ByteReader(data, big_endian), is_64_(is_64) {}
+
+    uint16_t Half(uint64_t offset) const { return U16(offset); }
+    uint32_t Word(uint64_t offset) const { return U32(offset); }
+    uint64_t Addr(uint64_t offset) const { return Read(offset, is_64_ ? 8 : 4); }
+
+private:
+    bool is_64_;
+};
+
+size_t HeaderSize(bool is_64) { return is_64 ? 64 : 52; }
+size_t SegmentEntrySize(bool is_64) { return is_64 ? 56 : 32; }
+size_t SectionEntrySize(bool is_64) { return is_64 ? 64 : 40; }
+size_t SymbolEntrySize(bool is_64) { return is_64 ? 24 : 16; }
+
+std::string SegmentName(uint32_t type) {
+    switch (type) {
+        case 1: return "LOAD";
+        case 2: return "DYNAMIC";
+        case 3: return "INTERP";
+        case 4: return "NOTE";
+        case 5: return "SHLIB";
+        case 6: return "PHDR";
+        case 7: return "TLS";
+        case 0x6474e550: return "GNU_EH_FRAME";
+        case 0x6474e551: return "GNU_STACK";
+        case 0x6474e552: return "GNU_RELRO";
+        case 0x6474e553: return "GNU_PROPERTY";
+        default: return "segment";
+    }
+}
+
+RegionKind SegmentKind(const ElfSegment& segment) {
+    if (segment.flags & pf_x) {
+        return RegionKind::Code;
+    }
+    if (segment.flags & pf_w) {
+        return RegionKind::Data;
+    }
+    return segment.type == pt_load ? RegionKind::ReadOnly : RegionKind::Other;
+}
+
+RegionKind SectionKind(const ElfSection& section) {
+    if (section.type == sht_symtab || section.type == sht_dynsym) {
+        return RegionKind::Symbols;
+    }
+    if (section.type == sht_strtab) {
+        return RegionKind::Strings;
+    }
+    if (section.flags & shf_execinstr) {
+        return RegionKind::Code;
+    }
+    if (section.flags & shf_write) {
+        return RegionKind::Data;
+    }
+    if (section.flags & shf_alloc) {
+        return RegionKind::ReadOnly;
+    }
+    return RegionKind::Other;
+}
+
+void ParseSegments(const ElfReader& reader, ElfLayout& layout, const std::atomic<bool>* cancel) {
+    const ElfHeader& header = layout.header;
+    const size_t entry_size = SegmentEntrySize(header.is_64);
+    if (header.phoff == 0 || header.phentsize < entry_size || !reader.Has(header.phoff, 0)) {
+        return;
+    }
+    for (uint64_t i = 0; i < header.phnum && !Cancelled(cancel); ++i) {
+        uint64_t offset = header.phoff + i * header.phentsize;
+        if (!reader.Has(offset, entry_size)) {
+            break;
+        }
+        ElfSegment segment;
+        segment.type = reader.Word(offset);
+        if (header.is_64) {
+            segment.flags = reader.Word(offset + 4);
+            segment.offset = reader.Addr(offset + 8);
+            segment.vaddr = reader.Addr(offset + 16);
+            segment.filesz = reader.Addr(offset + 32);
+            segment.memsz = reader.Addr(offset + 40);
+        } else {
+            segment.offset = reader.Addr(offset + 4);
+            segment.vaddr = reader.Addr(offset + 8);
+            segment.filesz = reader.Addr(offset + 16);
+            segment.memsz = reader.Addr(offset + 20);
+            segment.flags = reader.Word(offset + 24);
+        }
+        layout.segments.push_back(segment);
+    }
+}
+
+// The loadable segments, at their virtual addresses. Segments of a core dump
+// that weren't dumped have no bytes in the file.
+void MapSegments(ElfLayout& layout) {
+    for (const ElfSegment& segment : layout.segments) {
+        if (segment.type == pt_load) {
+            layout.addresses.Add(segment.offset, segment.vaddr, std::min(segment.filesz, segment.memsz));
+        }
+    }
+    layout.addresses.Finish();
+}
+
+void ParseSections(const ElfReader& reader, ElfLayout& layout, const std::atomic<bool>* cancel) {
+    const ElfHeader& header = layout.header;
+    const size_t entry_size = SectionEntrySize(header.is_64);
+    if (header.shoff == 0 || header.shentsize < entry_size || !reader.Has(header.shoff, 0)) {
+        return;
+    }
+    std::vector<uint32_t> name_offsets;
+    for (uint64_t i = 0; i < header.shnum && !Cancelled(cancel); ++i) {
+        uint64_t offset = header.shoff + i * header.shentsize;
+        if (!reader.Has(offset, entry_size)) {
+            break;
+        }
+        ElfSection section;
+        name_offsets.push_back(reader.Word(offset));
+        section.type = reader.Word(offset + 4);
+        if (header.is_64) {
+            section.flags = reader.Addr(offset + 8);
+            section.addr = reader.Addr(offset + 16);
+            section.offset = reader.Addr(offset + 24);
+            section.size = reader.Addr(offset + 32);
+            section.link = reader.Word(offset + 40);
+            section.info = reader.Word(offset + 44);
+            section.entsize = reader.Addr(offset + 56);
+        } else {
+            section.flags = reader.Addr(offset + 8);
+            section.addr = reader.Addr(offset + 12);
+            section.offset = reader.Addr(offset + 16);
+            section.size = reader.Addr(offset + 20);
+            section.link = reader.Word(offset + 24);
+            section.info = reader.Word(offset + 28);
+            section.entsize = reader.Addr(offset + 36);
+        }
+        layout.sections.push_back(section);
+    }
+
+    // Names live in the section header string table.
+    if (header.shstrndx >= layout.sections.size()) {
+        return;
+    }
+    const ElfSection& names = layout.sections[header.shstrndx];
+    if (names.type == sht_nobits || !reader.Has(names.offset, 0)) {
+        return;
+    }
+    uint64_t names_end = names.offset + std::min<uint64_t>(names.size, UINT64_MAX - names.offset);
+    for (size_t i = 0; i < layout.sections.size(); ++i) {
+        if (name_offsets[i] < names.size) {
+            layout.sections[i].name = reader.String(names.offset + name_offsets[i], names_end);
+        }
+    }
+}
+
+void BuildRegions(ElfLayout& layout, size_t file_size) {
+    const ElfHeader& header = layout.header;
+
+    // A section as large as its segment is more specific: it comes later.
+    std::vector<Region> regions;
+    for (size_t i = 0; i < layout.segments.size(); ++i) {
+        const ElfSegment& segment = layout.segments[i];
+        if (segment.type == pt_null || segment.type == pt_phdr) {
+            continue;
+        }
+        auto region = ClippedRegion(segment.offset, segment.filesz, file_size,
+                                    SegmentName(segment.type) + " #" + std::to_string(i),
+                                    SegmentKind(segment));
+        if (region) {
+            regions.push_back(*region);
+        }
+    }
+    for (size_t i = 0; i < layout.sections.size(); ++i) {
+        const ElfSection& section = layout.sections[i];
+        if (section.type == sht_null || section.type == sht_nobits) {
+            continue;
+        }
+        std::string name = section.name.empty() ? "section #" + std::to_string(i) : section.name;
+        auto region = ClippedRegion(section.offset, section.size, file_size,
+                                    std::move(name), SectionKind(section));
+        if (region) {
+            regions.push_back(*region);
+        }
+    }
+    layout.regions.PaintNested(std::move(regions));
+
+    // The header tables are inside the first segment.
+    const uint64_t phdr_table_size = uint64_t(header.phnum) * header.phentsize;
+    const uint64_t shdr_table_size = uint64_t(header.shnum) * header.shentsize;
+    if (header.phoff != 0) {
+        if (auto region = ClippedRegion(header.phoff, phdr_table_size, file_size,
+                                        "program headers", RegionKind::Table)) {
+            layout.regions.Paint(*region);
+        }
+    }
+    if (header.shoff != 0) {
+        if (auto region = ClippedRegion(header.shoff, shdr_table_size, file_size,
+                                        "section headers", RegionKind::Table)) {
+            layout.regions.Paint(*region);
+        }
+    }
+    layout.regions.Paint(*ClippedRegion(0, HeaderSize(header.is_64), file_size,
+                                        "ELF header", RegionKind::Header));
+}
+
+// Functions and objects whose bytes are in the file: defined in a section
+// that isn't zero-filled.
+void ParseSymbols(const ElfReader& reader, ElfLayout& layout, const std::atomic<bool>* cancel) {
+    const ElfHeader& header = layout.header;
+    const size_t entry_size = SymbolEntrySize(header.is_64);
+    for (const ElfSection& table : layout.sections) {
+        if ((table.type != sht_symtab && table.type != sht_dynsym) || table.link >= layout.sections.size() ||
+            !reader.Has(table.offset, 0)) {
+            continue;
+        }
+        const ElfSection& strings = layout.sections[table.link];
+        if (strings.type == sht_nobits || !reader.Has(strings.offset, 0)) {
+            continue;
+        }
+        const uint64_t strings_end = strings.offset + std::min<uint64_t>(strings.size, UINT64_MAX - strings.offset);
+        const uint64_t stride = std::max<uint64_t>(table.entsize, entry_size);
+        const uint64_t count = std::min(table.size, reader.size() - table.offset) / stride;
+
+        // Symbol 0 is undefined.
+        for (uint64_t i = 1; i < count; ++i) {
+            if (Cancelled(cancel)) {
+                return;
+            }
+            const uint64_t offset = table.offset + i * stride;
+            uint32_t name;
+            uint8_t info;
+            uint16_t index;
+            uint64_t value;
+            uint64_t size;
+            if (header.is_64) {
+                name = reader.Word(offset);
+                info = reader.U8(offset + 4);
+                index = reader.Half(offset + 6);
+                value = reader.Addr(offset + 8);
+                size = reader.Addr(offset + 16);
+            } else {
+                name = reader.Word(offset);
+                value = reader.Addr(offset + 4);
+                size = reader.Word(offset + 8);
+                info = reader.U8(offset + 12);
+                index = reader.Half(offset + 14);
+            }
+            const uint8_t type = info & 0xf;
+            if ((type != stt_notype && type != stt_object && type != stt_func && type != stt_gnu_ifunc) ||
+                index == shn_undef || index >= shn_loreserve || index >= layout.sections.size() ||
+                name >= strings.size) {
+                continue;
+            }
+            // Values are relative to the section in relocatable files,
+            // addresses in the others.
+            const ElfSection& section = layout.sections[index];
+            if (section.type == sht_nobits || (header.type != et_rel && value < section.addr)) {
+                continue;
+            }
+            const uint64_t relative = header.type == et_rel ? value : value - section.addr;
+            if (relative > section.size) {
+                continue;
+            }
+            std::string symbol = reader.String(strings.offset + name, strings_end);
+            if (!symbol.empty()) {
+                layout.symbols.Add(symbol, section.offset + relative, size);
+            }
+        }
+    }
+    layout.symbols.Finish();
+}
+
+// Nothing once cancelled: the tables may have been cut short.
+std::optional<ElfLayout> ParseElf(std::string_view data, bool with_sections, const std::atomic<bool>* cancel) {
+    auto header = ParseElfHeader(data);
+    if (!header) {
+        return std::nullopt;
+    }
+    ElfLayout layout;
+    layout.header = *header;
+    ElfReader reader(data, header->big_endian, header->is_64);
+    ParseSegments(reader, layout, cancel);
+    MapSegments(layout);
+    if (with_sections) {
+        ParseSections(reader, layout, cancel);
+        ParseSymbols(reader, layout, cancel);
+    }
+    if (Cancelled(cancel)) {
+        return std::nullopt;
+    }
+    BuildRegions(layout, data.size());
+    return layout;
+}
+
+}  // namespace
+
+bool IsElf(std::string_view data) {
+    return data.size() >= sizeof(elf_magic) &&
+           std::equal(std::begin(elf_magic), std::end(elf_magic),
+                      reinterpret_cast<const unsigned char*>(data.data()));
+}
+
+std::optional<ElfHeader> ParseElfHeader(std::string_view data) {
+    if (!IsElf(data) || data.size() <= ei_data) {
+        return std::nullopt;
+    }
+    const unsigned char elf_class = static_cast<unsigned char>(data[ei_class]);
+    const unsigned char elf_data = static_cast<unsigned char>(data[ei_data]);
+    if ((elf_class != elf_class_32 && elf_class != elf_class_64) ||
+        (elf_data != elf_data_lsb && elf_data != elf_data_msb)) {
+        return std::nullopt;
+    }
+
+    ElfHeader header;
+    header.is_64 = elf_class == elf_class_64;
+    header.big_endian = elf_data == elf_data_msb;
+    if (data.size() < HeaderSize(header.is_64)) {
+        return std::nullopt;
+    }
+
+    // The fields after e_entry are shifted by the size of the addresses.
+    ElfReader reader(data, header.big_endian, header.is_64);
+    const size_t addr = header.is_64 ? 8 : 4;
+    header.type = reader.Half(16);
+    header.machine = reader.Half(18);
+    header.entry = reader.Addr(24);
+    header.phoff = reader.Addr(24 + addr);
+    header.shoff = reader.Addr(24 + 2 * addr);
+    header.ehsize = reader.Half(28 + 3 * addr);
+    header.phentsize = reader.Half(30 + 3 * addr);
+    header.phnum = reader.Half(32 + 3 * addr);
+    header.shentsize = reader.Half(34 + 3 * addr);
+    header.shnum = reader.Half(36 + 3 * addr);
+    header.shstrndx = reader.Half(38 + 3 * addr);
+
+    // Escaped values are stored in the first section header.
+    const bool escaped_phnum = header.phnum == pn_xnum;
+    const bool escaped_shnum = header.shnum == 0 && header.shoff != 0;
+    const bool escaped_shstrndx = header.shstrndx == shn_xindex;
+    const size_t entry_size = SectionEntrySize(header.is_64);
+    if ((escaped_phnum || escaped_shnum || escaped_shstrndx) && header.shoff != 0 &&
+        header.shentsize >= entry_size && reader.Has(header.shoff, entry_size)) {
+        if (escaped_shnum) {
+            uint64_t size = reader.Addr(header.shoff + (header.is_64 ? 32 : 20));
+            header.shnum = static_cast<uint32_t>(std::min<uint64_t>(size, UINT32_MAX));
+        }
+        if (escaped_shstrndx) {
+            header.shstrndx = reader.Word(header.shoff + (header.is_64 ? 40 : 24));
+        }
+        if (escaped_phnum) {
+            header.phnum = reader.Word(header.shoff + (header.is_64 ? 44 : 28));
+        }
+    }
+    return header;
+}
+
+std::optional<ElfLayout> ParseElfLayout(std::string_view data, const std::atomic<bool>* cancel) {
+    return ParseElf(data, true, cancel);
+}
+
+std::optional<ElfLayout> ParseElfSegments(std::string_view data, const std::atomic<bool>* cancel) {
+    return ParseElf(data, false, cancel);
+}
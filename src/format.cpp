@@ -0,0 +1,108 @@
+#include "format.hpp"
+
+#include "elf.hpp"
+#include "gif.hpp"
+#include "jpeg.hpp"
+#include "macho.hpp"
+#include "pe.hpp"
+#include "png.hpp"
+#include "riff.hpp"
+#include "tar.hpp"
+#include "zip.hpp"
+
+namespace {
+
+using namespace std::string_view_literals;
+
+template <typename File>
+FormatDetector Detector(std::string name, std::string_view magic,
+                        bool (*match)(std::string_view) = nullptr, size_t magic_offset = 0) {
+    FormatDetector detector;
+    detector.name = std::move(name);
+    detector.magic = std::string(magic);
+    detector.magic_offset = magic_offset;
+    detector.match = match;
+    detector.create = [](const std::string& name) -> std::unique_ptr<Format> {
+        return std::make_unique<File>(name);
+    };
+    return detector;
+}
+
+FormatRegistry MakeDefaultRegistry() {
+    FormatRegistry registry;
+    registry.Register(Detector<ElfFile>("ELF", "\x7f" "ELF"sv));
+    registry.Register(Detector<PeFile>("PE", "MZ"sv));
+    registry.Register(Detector<PngFile>("PNG", "\x89PNG\r\n\x1a\n"sv));
+    // Mach-O, in both byte orders, and fat binaries.
+    for (std::string_view magic : { "\xfe\xed\xfa\xce"sv, "\xce\xfa\xed\xfe"sv,
+                                    "\xfe\xed\xfa\xcf"sv, "\xcf\xfa\xed\xfe"sv,
+                                    "\xca\xfe\xba\xbe"sv, "\xbe\xba\xfe\xca"sv,
+                                    "\xca\xfe\xba\xbf"sv, "\xbf\xba\xfe\xca"sv }) {
+        registry.Register(Detector<MachOFile>("Mach-O", magic, IsMachO));
+    }
+    registry.Register(Detector<JpegFile>("JPEG", "\xff\xd8\xff"sv));
+    registry.Register(Detector<GifFile>("GIF", "GIF87a"sv));
+    registry.Register(Detector<GifFile>("GIF", "GIF89a"sv));
+    // The form type of a RIFF file names it. RF64 is WAV past 4 GiB.
+    registry.Register(Detector<RiffFile>("WAV", "RIFF"sv,
+                                         [](std::string_view data) { return RiffForm(data) == "WAVE"; }));
+    registry.Register(Detector<RiffFile>("AVI", "RIFF"sv,
+                                         [](std::string_view data) { return RiffForm(data) == "AVI "; }));
+    registry.Register(Detector<RiffFile>("WebP", "RIFF"sv,
+                                         [](std::string_view data) { return RiffForm(data) == "WEBP"; }));
+    registry.Register(Detector<RiffFile>("RIFF", "RIFF"sv, IsRiff));
+    registry.Register(Detector<RiffFile>("WAV", "RF64"sv, IsRiff));
+    registry.Register(Detector<ZipFile>("ZIP", "PK\x03\x04"sv, IsZip));
+    registry.Register(Detector<TarFile>("tar", "ustar"sv, IsTar, 257));
+    // Empty archives, and archives after a self-extracting stub or a launcher
+    // script, are found from their end record. Tried last: it scans the end
+    // of every file no other format matched.
+    registry.Register(Detector<ZipFile>("ZIP", ""sv, IsZip));
+    return registry;
+}
+
+}  // namespace
+
+void Format::Analyze(std::string_view data, const PublishRegions& publish, const std::atomic<bool>&) {
+    if (const RegionMap* regions = Regions(data)) {
+        publish(*regions, 1);
+    }
+}
+
+void FormatRegistry::Register(FormatDetector detector) {
+    if (detector.magic_offset == 0 && !detector.magic.empty()) {
+        by_first_byte_[static_cast<unsigned char>(detector.magic[0])].push_back(std::move(detector));
+    } else {
+        at_offset_.push_back(std::move(detector));
+    }
+}
+
+bool FormatRegistry::Matches(const FormatDetector& detector, std::string_view data) {
+    if (data.size() < detector.magic_offset ||
+        data.size() - detector.magic_offset < detector.magic.size() ||
+        data.substr(detector.magic_offset, detector.magic.size()) != detector.magic) {
+        return false;
+    }
+    return !detector.match || detector.match(data);
+}
+
+std::unique_ptr<Format> FormatRegistry::Detect(std::string_view data) const {
+    if (!data.empty()) {
+        for (const FormatDetector& detector : by_first_byte_[static_cast<unsigned char>(data[0])]) {
+            if (Matches(detector, data)) {
+                return detector.create(detector.name);
+            }
+        }
+    }
+    for (const FormatDetector& detector : at_offset_) {
+        if (Matches(detector, data)) {
+            return detector.create(detector.name);
+        }
+    }
+    return nullptr;
+}
+
+const FormatRegistry& FormatRegistry::Default() {
+    static const FormatRegistry registry = MakeDefaultRegistry();
+    return registry;
+}
@@ -0,0 +1,164 @@
+#include "gif.hpp"
+
+#include "byte_reader.hpp"
+
+#include <algorithm>
+
+namespace {
+
+const size_t header_size = 6;
+const size_t screen_descriptor_size = 7;
+const size_t image_descriptor_size = 10;
+
+// Block introducers
+const uint8_t extension_introducer = 0x21;
+const uint8_t image_separator = 0x2c;
+const uint8_t trailer = 0x3b;
+
+// Extension labels
+const uint8_t plain_text_label = 0x01;
+const uint8_t graphic_control_label = 0xf9;
+const uint8_t comment_label = 0xfe;
+const uint8_t application_label = 0xff;
+
+// Packed fields of the screen and image descriptors
+const uint8_t color_table_flag = 0x80;
+
+// 3 bytes per color, 2^(n + 1) colors.
+uint64_t ColorTableSize(uint8_t packed) {
+    return (packed & color_table_flag) ? 3u << ((packed & 0x07) + 1) : 0;
+}
+
+// The end of the chain of sub-blocks at offset: a size byte, that many
+// bytes, up to an empty one. Nothing if the file ends first.
+std::optional<uint64_t> SkipSubBlocks(const ByteReader& reader, uint64_t offset) {
+    while (reader.Has(offset, 1)) {
+        const uint8_t size = reader.U8(offset);
+        offset += 1 + size;
+        if (size == 0) {
+            return offset;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string ExtensionName(const ByteReader& reader, uint8_t label, uint64_t offset) {
+    switch (label) {
+        case plain_text_label: return "plain text extension";
+        case graphic_control_label: return "graphic control extension";
+        case comment_label: return "comment";
+        case application_label:
+            // An 11-byte sub-block: identifier and authentication code,
+            // "NETSCAPE2.0" for looping animations.
+            if (reader.Has(offset + 2, 12) && reader.U8(offset + 2) == 11) {
+                std::string identifier = reader.String(offset + 3, offset + 14);
+                for (char c : identifier) {
+                    if (c < 0x20 || c > 0x7e) {
+                        return "application extension";
+                    }
+                }
+                return "application extension " + identifier;
+            }
+            return "application extension";
+    }
+    return "extension";
+}
+
+RegionKind ExtensionKind(uint8_t label) {
+    switch (label) {
+        case graphic_control_label: return RegionKind::Header;
+        case comment_label:
+        case plain_text_label: return RegionKind::Strings;
+    }
+    return RegionKind::Other;
+}
+
+}  // namespace
+
+bool IsGif(std::string_view data) {
+    return data.size() >= header_size && (data.substr(0, 6) == "GIF87a" || data.substr(0, 6) == "GIF89a");
+}
+
+std::optional<GifLayout> ParseGifLayout(std::string_view data) {
+    if (!IsGif(data)) {
+        return std::nullopt;
+    }
+    GifLayout layout;
+    ByteReader reader(data);
+    const size_t file_size = data.size();
+    std::vector<Region> regions;
+    auto add = [&](uint64_t offset, uint64_t size, std::string name, RegionKind kind) {
+        layout.blocks.push_back({ offset, size, name });
+        if (auto region = ClippedRegion(offset, size, file_size, std::move(name), kind)) {
+            regions.push_back(*region);
+        }
+    };
+
+    add(0, header_size, "GIF header", RegionKind::Header);
+    if (!reader.Has(header_size, screen_descriptor_size)) {
+        layout.truncated = true;
+        add(header_size, screen_descriptor_size, "logical screen descriptor (truncated)", RegionKind::Corrupt);
+        layout.regions.PaintNested(std::move(regions));
+        return layout;
+    }
+    layout.width = reader.U16(header_size);
+    layout.height = reader.U16(header_size + 2);
+    add(header_size, screen_descriptor_size, "logical screen descriptor", RegionKind::Header);
+    uint64_t offset = header_size + screen_descriptor_size;
+    if (uint64_t size = ColorTableSize(reader.U8(header_size + 4))) {
+        add(offset, size, "global color table", RegionKind::Table);
+        offset += size;
+    }
+
+    while (true) {
+        if (!reader.Has(offset, 1)) {
+            layout.truncated = true;
+            break;
+        }
+        const uint8_t introducer = reader.U8(offset);
+        if (introducer == trailer) {
+            add(offset, 1, "trailer", RegionKind::Header);
+            if (offset + 1 < file_size) {
+                add(offset + 1, file_size - offset - 1, "trailing data", RegionKind::Other);
+            }
+            break;
+        }
+        if (introducer == extension_introducer && reader.Has(offset, 2)) {
+            const uint8_t label = reader.U8(offset + 1);
+            std::string name = ExtensionName(reader, label, offset);
+            auto end = SkipSubBlocks(reader, offset + 2);
+            if (!end) {
+                layout.truncated = true;
+                add(offset, file_size - offset, name + " (truncated)", RegionKind::Corrupt);
+                break;
+            }
+            add(offset, *end - offset, std::move(name), ExtensionKind(label));
+            offset = *end;
+            continue;
+        }
+        if (introducer == image_separator && reader.Has(offset, image_descriptor_size)) {
+            const std::string image = "image " + std::to_string(++layout.images);
+            add(offset, image_descriptor_size, image + " descriptor", RegionKind::Header);
+            offset += image_descriptor_size;
+            if (uint64_t size = ColorTableSize(reader.U8(offset - 1))) {
+                add(offset, size, image + " color table", RegionKind::Table);
+                offset += size;
+            }
+            // The LZW minimum code size, then the sub-blocks.
+            auto end = SkipSubBlocks(reader, offset + 1);
+            if (!end) {
+                layout.truncated = true;
+                add(offset, file_size - std::min<uint64_t>(offset, file_size), image + " data (truncated)",
+                    RegionKind::Corrupt);
+                break;
+            }
+            add(offset, *end - offset, image + " data", RegionKind::Data);
+            offset = *end;
+            continue;
+        }
+        add(offset, file_size - offset, "unknown block", RegionKind::Corrupt);
+        break;
+    }
+    layout.regions.PaintNested(std::move(regions));
+    return layout;
+}
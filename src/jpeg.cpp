@@ -0,0 +1,193 @@
+#include "jpeg.hpp"
+
+#include "byte_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace {
+
+// Markers
+const uint8_t tem = 0x01;
+const uint8_t sof0 = 0xc0;
+const uint8_t dht = 0xc4;
+const uint8_t jpg = 0xc8;
+const uint8_t dac = 0xcc;
+const uint8_t rst0 = 0xd0;
+const uint8_t rst7 = 0xd7;
+const uint8_t soi = 0xd8;
+const uint8_t eoi = 0xd9;
+const uint8_t sos = 0xda;
+const uint8_t dqt = 0xdb;
+const uint8_t dnl = 0xdc;
+const uint8_t dri = 0xdd;
+const uint8_t app0 = 0xe0;
+const uint8_t app15 = 0xef;
+const uint8_t com = 0xfe;
+
+// Application segments start with a NUL-terminated identifier.
+const size_t max_identifier_size = 32;
+
+// Markers without a length and a payload.
+bool IsStandalone(uint8_t marker) {
+    return marker == tem || (marker >= rst0 && marker <= eoi);
+}
+
+// "APP1 Exif", "APP2 ICC_PROFILE"...
+std::string AppName(const ByteReader& reader, uint8_t marker, uint64_t payload, uint64_t payload_end) {
+    std::string name = "APP" + std::to_string(marker - app0);
+    std::string identifier = reader.String(payload, std::min(payload_end, payload + max_identifier_size));
+    if (identifier.rfind("http://ns.adobe.com/xap/", 0) == 0) {
+        return name + " XMP";
+    }
+    for (char c : identifier) {
+        if (c < 0x20 || c > 0x7e) {
+            return name;
+        }
+    }
+    return identifier.empty() ? name : name + " " + identifier;
+}
+
+std::string MarkerName(uint8_t marker) {
+    switch (marker) {
+        case tem: return "TEM";
+        case dht: return "DHT";
+        case jpg: return "JPG";
+        case dac: return "DAC";
+        case soi: return "SOI";
+        case eoi: return "EOI";
+        case sos: return "SOS";
+        case dqt: return "DQT";
+        case dnl: return "DNL";
+        case dri: return "DRI";
+        case com: return "COM";
+    }
+    if (marker >= sof0 && marker <= 0xcf) {
+        return "SOF" + std::to_string(marker - sof0);
+    }
+    if (marker >= rst0 && marker <= rst7) {
+        return "RST" + std::to_string(marker - rst0);
+    }
+    const char* digits = "0123456789ABCDEF";
+    return std::string("marker 0x") + digits[marker >> 4] + digits[marker & 0xf];
+}
+
+RegionKind MarkerKind(uint8_t marker) {
+    if (marker == dqt || marker == dht || marker == dac) {
+        return RegionKind::Table;
+    }
+    if (marker >= app0 && marker <= app15) {
+        return RegionKind::Other;
+    }
+    if (marker == com) {
+        return RegionKind::Strings;
+    }
+    if ((marker >= sof0 && marker <= 0xcf) || marker == soi || marker == eoi || marker == sos ||
+        marker == dnl || marker == dri) {
+        return RegionKind::Header;
+    }
+    return RegionKind::Other;
+}
+
+// Where the entropy-coded data starting at offset ends: at the first marker
+// other than a stuffed 0xFF00 or a restart marker.
+uint64_t ScanEnd(std::string_view data, uint64_t offset) {
+    while (offset < data.size()) {
+        const void* found = std::memchr(data.data() + offset, 0xff, data.size() - offset);
+        if (!found) {
+            return data.size();
+        }
+        offset = static_cast<const char*>(found) - data.data();
+        if (offset + 1 >= data.size()) {
+            return data.size();
+        }
+        const uint8_t next = static_cast<uint8_t>(data[offset + 1]);
+        if (next != 0x00 && (next < rst0 || next > rst7)) {
+            return offset;
+        }
+        offset += 2;
+    }
+    return data.size();
+}
+
+}  // namespace
+
+bool IsJpeg(std::string_view data) {
+    return data.size() >= 3 && data.substr(0, 3) == "\xff\xd8\xff";
+}
+
+std::optional<JpegLayout> ParseJpegLayout(std::string_view data) {
+    if (!IsJpeg(data)) {
+        return std::nullopt;
+    }
+    JpegLayout layout;
+    ByteReader reader(data, true);
+    const size_t file_size = data.size();
+    std::vector<Region> regions;
+
+    uint64_t offset = 0;
+    while (offset < file_size) {
+        if (reader.U8(offset) != 0xff) {
+            regions.push_back(*ClippedRegion(offset, file_size - offset, file_size,
+                                             "not a marker", RegionKind::Corrupt));
+            break;
+        }
+        // Any number of fill bytes may come before a marker.
+        JpegSegment segment{ offset, 0, 0, false };
+        while (offset + 1 < file_size && reader.U8(offset + 1) == 0xff) {
+            ++offset;
+        }
+        if (offset + 1 >= file_size) {
+            segment.size = file_size - segment.offset;
+            segment.truncated = true;
+        } else {
+            segment.marker = reader.U8(offset + 1);
+            uint64_t length = 0;
+            if (!IsStandalone(segment.marker)) {
+                // The length counts itself, not the marker.
+                length = reader.Has(offset + 2, 2) ? reader.U16(offset + 2) : 0;
+                segment.truncated = length < 2 || !reader.Has(offset + 2, length);
+            }
+            segment.size = offset + 2 + length - segment.offset;
+        }
+
+        std::string name = MarkerName(segment.marker);
+        if (segment.marker >= app0 && segment.marker <= app15 && !segment.truncated) {
+            name = AppName(reader, segment.marker, offset + 4, segment.offset + segment.size);
+        }
+        if (auto region = ClippedRegion(segment.offset, segment.size, file_size,
+                                        segment.truncated ? name + " (truncated)" : name,
+                                        segment.truncated ? RegionKind::Corrupt : MarkerKind(segment.marker))) {
+            regions.push_back(*region);
+        }
+        layout.segments.push_back(segment);
+        if (segment.truncated) {
+            break;
+        }
+        offset = segment.offset + segment.size;
+
+        if (segment.marker == eoi) {
+            // Thumbnails and motion photo videos are often appended.
+            if (auto region = ClippedRegion(offset, file_size - offset, file_size,
+                                            "trailing data", RegionKind::Other)) {
+                regions.push_back(*region);
+            }
+            break;
+        }
+        if (segment.marker == sos) {
+            const uint64_t end = ScanEnd(data, offset);
+            ++layout.scans;
+            if (auto region = ClippedRegion(offset, end - offset, file_size,
+                                            "scan " + std::to_string(layout.scans) + " data", RegionKind::Data)) {
+                regions.push_back(*region);
+            }
+            offset = end;
+        }
+    }
+    // Segments don't overlap: the order doesn't matter.
+    for (const Region& region : regions) {
+        layout.regions.Paint(region);
+    }
+    return layout;
+}
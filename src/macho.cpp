@@ -0,0 +1,439 @@
+#include "macho.hpp"
+
+#include "byte_reader.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Magic numbers, read as big-endian. Swapped ones are written by
+// little-endian machines.
+const uint32_t mh_magic = 0xfeedface;
+const uint32_t mh_cigam = 0xcefaedfe;
+const uint32_t mh_magic_64 = 0xfeedfacf;
+const uint32_t mh_cigam_64 = 0xcffaedfe;
+const uint32_t fat_magic = 0xcafebabe;
+const uint32_t fat_cigam = 0xbebafeca;
+const uint32_t fat_magic_64 = 0xcafebabf;
+const uint32_t fat_cigam_64 = 0xbfbafeca;
+
+// Java class files share the fat magic. Their version takes the place of the
+// arch count, and is larger than any real count.
+const uint32_t max_fat_archs = 30;
+
+const size_t fat_header_size = 8;
+const size_t fat_arch_size = 20;
+const size_t fat_arch_64_size = 32;
+const size_t header_size = 28;
+const size_t header_64_size = 32;
+const size_t segment_command_size = 56;
+const size_t segment_command_64_size = 72;
+const size_t section_size = 68;
+const size_t section_64_size = 80;
+const size_t nlist_size = 12;
+const size_t nlist_64_size = 16;
+// Longer names are cut, corrupted commands don't read the whole file.
+const size_t max_name_size = 256;
+
+// Load commands
+const uint32_t lc_segment = 0x1;
+const uint32_t lc_symtab = 0x2;
+const uint32_t lc_dysymtab = 0xb;
+const uint32_t lc_load_dylib = 0xc;
+const uint32_t lc_id_dylib = 0xd;
+const uint32_t lc_load_dylinker = 0xe;
+const uint32_t lc_segment_64 = 0x19;
+const uint32_t lc_code_signature = 0x1d;
+const uint32_t lc_segment_split_info = 0x1e;
+const uint32_t lc_dyld_info = 0x22;
+const uint32_t lc_dyld_info_only = 0x80000022;
+const uint32_t lc_function_starts = 0x26;
+const uint32_t lc_data_in_code = 0x29;
+const uint32_t lc_dylib_code_sign_drs = 0x2b;
+const uint32_t lc_linker_optimization_hint = 0x2e;
+const uint32_t lc_load_weak_dylib = 0x80000018;
+const uint32_t lc_rpath = 0x8000001c;
+const uint32_t lc_reexport_dylib = 0x8000001f;
+const uint32_t lc_dyld_exports_trie = 0x80000033;
+const uint32_t lc_dyld_chained_fixups = 0x80000034;
+
+// Protections and section flags
+const uint32_t vm_prot_write = 0x2;
+const uint32_t vm_prot_execute = 0x4;
+const uint32_t section_type_mask = 0xff;
+const uint32_t s_zerofill = 0x1;
+const uint32_t s_cstring_literals = 0x2;
+const uint32_t s_gb_zerofill = 0xc;
+const uint32_t s_thread_local_zerofill = 0x12;
+const uint32_t s_attr_pure_instructions = 0x80000000;
+const uint32_t s_attr_some_instructions = 0x00000400;
+
+std::string CpuName(uint32_t cputype) {
+    switch (cputype) {
+        case 7: return "i386";
+        case 0x01000007: return "x86_64";
+        case 12: return "arm";
+        case 0x0100000c: return "arm64";
+        case 0x0200000c: return "arm64_32";
+        case 18: return "ppc";
+        case 0x01000012: return "ppc64";
+        default: return "cpu " + std::to_string(cputype);
+    }
+}
+
+std::string LoadCommandName(uint32_t cmd) {
+    switch (cmd) {
+        case 0x1: return "LC_SEGMENT";
+        case 0x2: return "LC_SYMTAB";
+        case 0x4: return "LC_THREAD";
+        case 0x5: return "LC_UNIXTHREAD";
+        case 0xb: return "LC_DYSYMTAB";
+        case 0xc: return "LC_LOAD_DYLIB";
+        case 0xd: return "LC_ID_DYLIB";
+        case 0xe: return "LC_LOAD_DYLINKER";
+        case 0x19: return "LC_SEGMENT_64";
+        case 0x1b: return "LC_UUID";
+        case 0x1d: return "LC_CODE_SIGNATURE";
+        case 0x1e: return "LC_SEGMENT_SPLIT_INFO";
+        case 0x21: return "LC_ENCRYPTION_INFO";
+        case 0x22: return "LC_DYLD_INFO";
+        case 0x24: return "LC_VERSION_MIN_MACOSX";
+        case 0x25: return "LC_VERSION_MIN_IPHONEOS";
+        case 0x26: return "LC_FUNCTION_STARTS";
+        case 0x29: return "LC_DATA_IN_CODE";
+        case 0x2a: return "LC_SOURCE_VERSION";
+        case 0x2b: return "LC_DYLIB_CODE_SIGN_DRS";
+        case 0x2c: return "LC_ENCRYPTION_INFO_64";
+        case 0x2e: return "LC_LINKER_OPTIMIZATION_HINT";
+        case 0x31: return "LC_NOTE";
+        case 0x32: return "LC_BUILD_VERSION";
+        case 0x80000018: return "LC_LOAD_WEAK_DYLIB";
+        case 0x8000001c: return "LC_RPATH";
+        case 0x8000001f: return "LC_REEXPORT_DYLIB";
+        case 0x80000022: return "LC_DYLD_INFO_ONLY";
+        case 0x80000028: return "LC_MAIN";
+        case 0x80000033: return "LC_DYLD_EXPORTS_TRIE";
+        case 0x80000034: return "LC_DYLD_CHAINED_FIXUPS";
+        default: return "load command";
+    }
+}
+
+// The name of a __LINKEDIT blob described by a linkedit_data_command.
+const char* LinkeditDataName(uint32_t cmd) {
+    switch (cmd) {
+        case lc_code_signature: return "code signature";
+        case lc_segment_split_info: return "segment split info";
+        case lc_function_starts: return "function starts";
+        case lc_data_in_code: return "data in code";
+        case lc_dylib_code_sign_drs: return "code signing DRs";
+        case lc_linker_optimization_hint: return "linker optimization hints";
+        case lc_dyld_exports_trie: return "exports trie";
+        case lc_dyld_chained_fixups: return "chained fixups";
+        default: return nullptr;
+    }
+}
+
+RegionKind SegmentKind(const MachOSegment& segment) {
+    if (segment.initprot & vm_prot_execute) {
+        return RegionKind::Code;
+    }
+    if (segment.initprot & vm_prot_write) {
+        return RegionKind::Data;
+    }
+    return segment.name == "__LINKEDIT" ? RegionKind::Other : RegionKind::ReadOnly;
+}
+
+// Object files put every section in a single, unnamed and writable segment:
+// the segment name stored in the section is more telling.
+RegionKind SectionKind(const MachOSection& section, const MachOSegment& segment) {
+    if (section.flags & (s_attr_pure_instructions | s_attr_some_instructions)) {
+        return RegionKind::Code;
+    }
+    if ((section.flags & section_type_mask) == s_cstring_literals) {
+        return RegionKind::Strings;
+    }
+    if (section.segment.rfind("__DATA", 0) == 0) {
+        return RegionKind::Data;
+    }
+    if (section.segment == "__TEXT") {
+        return RegionKind::ReadOnly;
+    }
+    return segment.initprot & vm_prot_write ? RegionKind::Data : RegionKind::ReadOnly;
+}
+
+bool IsZeroFill(uint32_t flags) {
+    uint32_t type = flags & section_type_mask;
+    return type == s_zerofill || type == s_gb_zerofill || type == s_thread_local_zerofill;
+}
+
+// The regions of one slice. Offsets are relative to the slice, and clipped
+// to it: the caller moves them to the slice.
+class SliceParser {
+public:
+    SliceParser(std::string_view slice, bool big_endian, bool is_64, MachOSlice& out)
+        : reader_(slice, big_endian), is_64_(is_64), out_(out) {}
+
+    std::vector<Region> Parse() {
+        const size_t size_of_header = is_64_ ? header_64_size : header_size;
+        out_.filetype = reader_.U32(12);
+        const uint32_t ncmds = reader_.U32(16);
+        const uint64_t sizeofcmds = reader_.U32(20);
+        Add(0, size_of_header, "Mach-O header", RegionKind::Header);
+
+        const uint64_t commands_end = size_of_header + sizeofcmds;
+        uint64_t offset = size_of_header;
+        for (uint32_t i = 0; i < ncmds; ++i) {
+            if (!reader_.Has(offset, 8)) {
+                break;
+            }
+            const uint32_t cmd = reader_.U32(offset);
+            const uint32_t cmdsize = reader_.U32(offset + 4);
+            if (cmdsize < 8 || offset + cmdsize > commands_end || !reader_.Has(offset, cmdsize)) {
+                break;
+            }
+            ParseCommand(offset, cmd, cmdsize);
+            offset += cmdsize;
+        }
+        return std::move(regions_);
+    }
+
+private:
+    void Add(uint64_t offset, uint64_t size, std::string name, RegionKind kind) {
+        if (auto region = ClippedRegion(offset, size, reader_.size(), std::move(name), kind)) {
+            regions_.push_back(*region);
+        }
+    }
+
+    std::string Name16(uint64_t offset) const { return reader_.String(offset, offset + 16); }
+
+    // A string stored inside the command, at the offset read at field.
+    std::string CommandString(uint64_t offset, uint32_t cmdsize, uint64_t field) const {
+        if (field + 4 > cmdsize) {
+            return {};
+        }
+        uint32_t string_offset = reader_.U32(offset + field);
+        if (string_offset >= cmdsize) {
+            return {};
+        }
+        return reader_.String(offset + string_offset,
+                              offset + std::min<uint64_t>(cmdsize, string_offset + max_name_size));
+    }
+
+    void ParseCommand(uint64_t offset, uint32_t cmd, uint32_t cmdsize) {
+        std::string name = LoadCommandName(cmd);
+        switch (cmd) {
+            case lc_segment:
+            case lc_segment_64:
+                if (std::string segment = ParseSegment(offset, cmd == lc_segment_64, cmdsize); !segment.empty()) {
+                    name += " " + segment;
+                }
+                break;
+            case lc_symtab:
+                if (cmdsize >= 24) {
+                    const uint64_t symbols = reader_.U32(offset + 8);
+                    const uint64_t count = reader_.U32(offset + 12);
+                    Add(symbols, count * (is_64_ ? nlist_64_size : nlist_size), "symbol table", RegionKind::Symbols);
+                    Add(reader_.U32(offset + 16), reader_.U32(offset + 20), "string table", RegionKind::Strings);
+                }
+                break;
+            case lc_dysymtab:
+                if (cmdsize >= 64) {
+                    Add(reader_.U32(offset + 56), uint64_t(reader_.U32(offset + 60)) * 4,
+                        "indirect symbols", RegionKind::Symbols);
+                }
+                break;
+            case lc_dyld_info:
+            case lc_dyld_info_only:
+                if (cmdsize >= 48) {
+                    const char* names[] = { "rebase info", "binding info", "weak binding info",
+                                            "lazy binding info", "export info" };
+                    for (size_t i = 0; i < std::size(names); ++i) {
+                        Add(reader_.U32(offset + 8 + i * 8), reader_.U32(offset + 12 + i * 8),
+                            names[i], RegionKind::Table);
+                    }
+                }
+                break;
+            case lc_load_dylib:
+            case lc_id_dylib:
+            case lc_load_weak_dylib:
+            case lc_reexport_dylib:
+            case lc_load_dylinker:
+            case lc_rpath:
+                name += " " + CommandString(offset, cmdsize, 8);
+                break;
+            default:
+                if (const char* data_name = LinkeditDataName(cmd); data_name && cmdsize >= 16) {
+                    Add(reader_.U32(offset + 8), reader_.U32(offset + 12), data_name, RegionKind::Table);
+                }
+                break;
+        }
+        Add(offset, cmdsize, std::move(name), RegionKind::Table);
+    }
+
+    // Returns the name of the segment.
+    std::string ParseSegment(uint64_t offset, bool is_64, uint32_t cmdsize) {
+        const size_t command_size = is_64 ? segment_command_64_size : segment_command_size;
+        const size_t entry_size = is_64 ? section_64_size : section_size;
+        if (cmdsize < command_size) {
+            return {};
+        }
+        MachOSegment segment;
+        segment.name = Name16(offset + 8);
+        uint32_t nsects;
+        if (is_64) {
+            segment.vmaddr = reader_.U64(offset + 24);
+            segment.vmsize = reader_.U64(offset + 32);
+            segment.fileoff = reader_.U64(offset + 40);
+            segment.filesize = reader_.U64(offset + 48);
+            segment.initprot = reader_.U32(offset + 60);
+            nsects = reader_.U32(offset + 64);
+        } else {
+            segment.vmaddr = reader_.U32(offset + 24);
+            segment.vmsize = reader_.U32(offset + 28);
+            segment.fileoff = reader_.U32(offset + 32);
+            segment.filesize = reader_.U32(offset + 36);
+            segment.initprot = reader_.U32(offset + 44);
+            nsects = reader_.U32(offset + 48);
+        }
+        Add(segment.fileoff, segment.filesize, segment.name.empty() ? "segment" : segment.name,
+            SegmentKind(segment));
+
+        // The sections follow the command, inside it.
+        nsects = static_cast<uint32_t>(std::min<uint64_t>(nsects, (cmdsize - command_size) / entry_size));
+        for (uint32_t i = 0; i < nsects; ++i) {
+            const uint64_t entry = offset + command_size + i * entry_size;
+            MachOSection section;
+            section.name = Name16(entry);
+            section.segment = Name16(entry + 16);
+            if (is_64) {
+                section.addr = reader_.U64(entry + 32);
+                section.size = reader_.U64(entry + 40);
+                section.offset = reader_.U32(entry + 48);
+                section.flags = reader_.U32(entry + 64);
+            } else {
+                section.addr = reader_.U32(entry + 32);
+                section.size = reader_.U32(entry + 36);
+                section.offset = reader_.U32(entry + 40);
+                section.flags = reader_.U32(entry + 56);
+            }
+            if (!IsZeroFill(section.flags) && section.offset != 0) {
+                Add(section.offset, section.size, section.segment + "," + section.name,
+                    SectionKind(section, segment));
+            }
+            out_.sections.push_back(std::move(section));
+        }
+        out_.segments.push_back(segment);
+        return segment.name;
+    }
+
+    ByteReader reader_;
+    bool is_64_;
+    MachOSlice& out_;
+    std::vector<Region> regions_;
+};
+
+// Parse the thin Mach-O image in data[offset, offset + size), if it is one.
+// Its regions are added to regions, named after the architecture in fat
+// binaries.
+void ParseSlice(std::string_view data, uint64_t offset, uint64_t size, bool fat,
+                MachOLayout& layout, std::vector<Region>& regions) {
+    if (offset >= data.size()) {
+        return;
+    }
+    std::string_view slice = data.substr(offset, std::min<uint64_t>(size, data.size() - offset));
+    if (slice.size() < 4) {
+        return;
+    }
+    const uint32_t magic = ByteReader(slice, true).U32(0);
+    const bool is_64 = magic == mh_magic_64 || magic == mh_cigam_64;
+    const bool big_endian = magic == mh_magic || magic == mh_magic_64;
+    if (!is_64 && magic != mh_magic && magic != mh_cigam) {
+        return;
+    }
+    if (slice.size() < (is_64 ? header_64_size : header_size)) {
+        if (auto region = ClippedRegion(offset, slice.size(), data.size(),
+                                        "Mach-O header (truncated)", RegionKind::Corrupt)) {
+            regions.push_back(*region);
+        }
+        return;
+    }
+
+    MachOSlice out = {};
+    out.offset = offset;
+    out.size = slice.size();
+    out.is_64 = is_64;
+    out.big_endian = big_endian;
+    out.cputype = ByteReader(slice, big_endian).U32(4);
+    const std::string prefix = fat ? CpuName(out.cputype) + " " : "";
+    for (Region& region : SliceParser(slice, big_endian, is_64, out).Parse()) {
+        region.start += offset;
+        region.end += offset;
+        region.name = prefix + region.name;
+        regions.push_back(std::move(region));
+    }
+    layout.slices.push_back(std::move(out));
+}
+
+}  // namespace
+
+bool IsMachO(std::string_view data) {
+    if (data.size() < 8) {
+        return false;
+    }
+    ByteReader reader(data, true);
+    switch (reader.U32(0)) {
+        case mh_magic:
+        case mh_cigam:
+        case mh_magic_64:
+        case mh_cigam_64:
+            return true;
+        case fat_magic:
+        case fat_magic_64:
+            return reader.U32(4) <= max_fat_archs;
+        case fat_cigam:
+        case fat_cigam_64:
+            return ByteReader(data).U32(4) <= max_fat_archs;
+        default:
+            return false;
+    }
+}
+
+std::optional<MachOLayout> ParseMachOLayout(std::string_view data) {
+    if (!IsMachO(data)) {
+        return std::nullopt;
+    }
+    MachOLayout layout;
+    std::vector<Region> regions;
+    const uint32_t magic = ByteReader(data, true).U32(0);
+    if (magic == fat_magic || magic == fat_cigam || magic == fat_magic_64 || magic == fat_cigam_64) {
+        layout.fat = true;
+        const bool is_64 = magic == fat_magic_64 || magic == fat_cigam_64;
+        ByteReader reader(data, magic == fat_magic || magic == fat_magic_64);
+        const uint32_t count = reader.U32(4);
+        const size_t entry_size = is_64 ? fat_arch_64_size : fat_arch_size;
+        regions.push_back(*ClippedRegion(0, fat_header_size, data.size(), "fat header", RegionKind::Header));
+        if (auto region = ClippedRegion(fat_header_size, count * entry_size, data.size(),
+                                        "fat archs", RegionKind::Table)) {
+            regions.push_back(*region);
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint64_t entry = fat_header_size + i * entry_size;
+            if (!reader.Has(entry, entry_size)) {
+                break;
+            }
+            const uint32_t cputype = reader.U32(entry);
+            const uint64_t offset = is_64 ? reader.U64(entry + 8) : reader.U32(entry + 8);
+            const uint64_t size = is_64 ? reader.U64(entry + 16) : reader.U32(entry + 12);
+            if (auto region = ClippedRegion(offset, size, data.size(),
+                                            CpuName(cputype) + " slice", RegionKind::Other)) {
+                regions.push_back(*region);
+            }
+            ParseSlice(data, offset, size, true, layout, regions);
+        }
+    } else {
+        ParseSlice(data, 0, data.size(), false, layout, regions);
+    }
+    layout.regions.PaintNested(std::move(regions));
+    return layout;
+}
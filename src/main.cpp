@@ -2,15 +2,32 @@
 #include <ftxui/screen/screen.hpp>
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/event.hpp>
+#include <ftxui/component/loop.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/screen/color.hpp>
+#include <ftxui/screen/terminal.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <vector>
 #include <iomanip>
 #include <sstream>
 #include <cctype>
+#include <charconv>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string_view>
+#include <thread>
+
+#include "address_map.hpp"
+#include "format.hpp"
+#include "symbol_index.hpp"
 
 using namespace ftxui;
 
@@ -18,15 +35,27 @@ struct HexEditorState {
     std::string filename;
     std::vector<char> data;
     std::string status;
+    // The terminal doesn't keep up with the output, e.g. over a slow SSH link
+    bool link_congested = false;
+    // Reduce the output for slow links (--low-bandwidth)
+    bool low_bandwidth = false;
+    // Show the bytes sent for the previous frame (--debug-bytes)
+    bool debug_bytes = false;
+    size_t last_frame_bytes = 0;
 
     size_t cursor_line = 0;
     int cursor_col = 0;
     bool edit_mode = false;
     std::string edit_buffer;
 
-    // Display settings
-    const size_t visible_lines = 20;
+    // Display settings, recomputed by UpdateLayout() on terminal resize
+    size_t visible_lines = 20;
+    int bytes_per_line = 16;
     const size_t scroll_offset = 5;
+    std::string column_header;
+    Dimensions layout_size = {0, 0};
+    // Hex digits of the virtual address column, 0 without one
+    int address_digits = 0;
 
     // Search settings
     bool search_window_open = false;
@@ -35,105 +64,312 @@ struct HexEditorState {
     std::vector<size_t> search_results;
     size_t current_search_result = 0;
 
-    struct PartitionInfo {
-        size_t start;
-        size_t end;
-    };
-    
-    // Executable Partitions
-    std::optional<PartitionInfo> mz_partition;
-    std::optional<PartitionInfo> dos_stub_partition;
-    std::optional<PartitionInfo> pe_partition;
-    std::optional<PartitionInfo> elf_partition;
-    std::optional<PartitionInfo> mach_o_partition;
-
-    // PNG Partition
-    std::optional<PartitionInfo> signuature_partition;
-    std::optional<PartitionInfo> length_chunk_partition;
-    std::optional<PartitionInfo> type_chunk_partition;
-    std::optional<PartitionInfo> data_chunk_partition;
-    std::optional<PartitionInfo> crc_chunk_partition;
+    // Go to symbol prompt
+    bool symbol_prompt_open = false;
+    std::string symbol_query;
+
+    // Go to address prompt
+    bool address_prompt_open = false;
+    std::string address_query;
+
+    // File format: only its magic is checked when loading, its regions are
+    // analyzed on a worker thread
+    std::unique_ptr<Format> format;
+    std::shared_ptr<const RegionMap> regions;
+    std::thread analysis;
+    std::atomic<bool> analysis_cancel{false};
+    // Wakes up an analysis waiting to start, when it is cancelled
+    std::mutex analysis_mutex;
+    std::condition_variable analysis_wakeup;
+    // Regions posted by the analysis of older bytes are dropped
+    uint64_t analysis_generation = 0;
+    int analysis_step = 0;
+    bool analyzing = false;
 };
 
-enum Platform {
-    Windows, Linux, MacOS, Unknown
-};
+std::string_view DataView(const HexEditorState& state) {
+    return std::string_view(state.data.data(), state.data.size());
+}
 
-Platform CheckPlatforms(const HexEditorState& state) {
-    const unsigned char* header = reinterpret_cast<const unsigned char*>(state.data.data());
-    // MZ Mode
-    if (header[0] == 0x4d && // M
-        header[1] == 0x5a) { // Z
-        return Platform::Windows;
-    }
-    // ELF Mode
-    if (header[0] == 0x7f &&
-        header[1] == 0x45 && // E
-        header[2] == 0x4c && // L
-        header[3] == 0x46) { // F
-        return Platform::Linux;
-    }
-    // Mach-O Mode
-    if ((header[0] == 0xca && header[1] == 0xfe  &&
-         header[2] == 0xba && header[3] == 0xbe) ||  // Fat Binary
-        (header[0] == 0xfe && header[1] == 0xed  &&
-         header[2] == 0xfa && header[3] == 0xce) ||  // 32-bit Mach-O
-        (header[0] == 0xfe && header[1] == 0xed  &&
-         header[2] == 0xfa && header[3] == 0xcf) ) { // 64-bit Mach-O
-        return Platform::MacOS;
-    }
-    return Platform::Unknown;
+void DetectFormat(HexEditorState& state) {
+    state.format = FormatRegistry::Default().Detect(DataView(state));
+    if (state.format) {
+        state.status += " - " + state.format->name();
+    }
+}
+
+// The named regions of the file found so far by the analysis.
+const RegionMap* Regions(HexEditorState& state) {
+    return state.regions.get();
+}
+
+// Edits restart the analysis once they pause for this long, so that typing
+// a run of bytes parses the file once.
+const std::chrono::milliseconds analysis_restart_delay(300);
+
+// The worker reads the bytes: it must be stopped before they change. The
+// parsers check the cancel flag in their loops, so this doesn't wait for a
+// whole parse.
+void StopAnalysis(HexEditorState& state) {
+    if (state.analysis.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(state.analysis_mutex);
+            state.analysis_cancel = true;
+        }
+        state.analysis_wakeup.notify_all();
+        state.analysis.join();
+    }
+    state.analyzing = false;
 }
 
-void DetermineExecutablePartitions(HexEditorState& state) {
-    size_t file_size = state.data.size();
-    Platform plat = CheckPlatforms(state);
-    // MZ Check
-    if (plat == Windows) {
-        state.mz_partition = HexEditorState::PartitionInfo{0, 0x3f};
-        if (file_size >= 0x40) {
-            state.dos_stub_partition = HexEditorState::PartitionInfo{0x40, 0};
-            if (file_size >= 0x3c + 4) {
-                uint32_t e_lfanew = *(reinterpret_cast<const uint32_t*>(&state.data[0x3c]));
-                state.dos_stub_partition->end = e_lfanew - 1;
-                state.pe_partition = HexEditorState::PartitionInfo{e_lfanew, file_size - 1};
+// Parse the regions of the file on a worker, without blocking the UI on a
+// large binary. Each step of the analysis, the coarse regions first, is
+// posted to the UI thread and redrawn. The worker waits for delay first: an
+// edit in the meantime cancels it and starts another one. The regions of the
+// previous bytes are shown until replaced.
+void StartAnalysis(HexEditorState& state, ScreenInteractive& screen,
+                   std::chrono::milliseconds delay = std::chrono::milliseconds(0)) {
+    StopAnalysis(state);
+    if (!state.format) {
+        state.regions.reset();
+        return;
+    }
+    // The bytes may have changed since the last analysis.
+    state.format->Invalidate();
+    state.analysis_cancel = false;
+    state.analysis_step = 0;
+    state.analyzing = true;
+    const uint64_t generation = ++state.analysis_generation;
+    Format* format = state.format.get();
+    std::string_view data = DataView(state);
+    state.analysis = std::thread([&state, &screen, generation, format, data, delay] {
+        if (delay.count() > 0) {
+            std::unique_lock<std::mutex> lock(state.analysis_mutex);
+            if (state.analysis_wakeup.wait_for(lock, delay, [&] { return state.analysis_cancel.load(); })) {
+                return;
             }
         }
+        auto post = [&](std::function<void(HexEditorState&)> update) {
+            screen.Post([&state, generation, update] {
+                if (state.analysis_generation == generation) {
+                    update(state);
+                }
+            });
+            screen.PostEvent(Event::Custom);
+        };
+        format->Analyze(data, [&](const RegionMap& regions, int step) {
+            auto published = std::make_shared<const RegionMap>(regions);
+            post([published, step](HexEditorState& state) {
+                state.regions = published;
+                state.analysis_step = step;
+            });
+        }, state.analysis_cancel);
+        post([](HexEditorState& state) { state.analyzing = false; });
+    });
+}
+
+void MoveCursorTo(HexEditorState& state, size_t pos) {
+    state.cursor_line = pos / state.bytes_per_line;
+    state.cursor_col = static_cast<int>(pos % state.bytes_per_line);
+}
+
+// Move the cursor to the start of the next or previous region.
+void JumpToRegion(HexEditorState& state, bool forward) {
+    const RegionMap* regions = Regions(state);
+    if (!regions || regions->empty()) {
+        return;
+    }
+    size_t pos = state.cursor_line * state.bytes_per_line + state.cursor_col;
+    const Region* region = forward ? regions->Next(pos) : regions->Previous(pos);
+    // The regions may be of the bytes before an edit, until they are replaced.
+    if (!region || region->start >= state.data.size()) {
+        state.status = forward ? "No region after the cursor" : "No region before the cursor";
+        return;
+    }
+    MoveCursorTo(state, region->start);
+    std::stringstream ss;
+    ss << region->name << " at 0x" << std::hex << region->start;
+    state.status = ss.str();
+}
+
+// The symbols of the file, once the analysis is done: the worker owns the
+// parsed layout until then.
+const SymbolIndex* Symbols(HexEditorState& state) {
+    if (!state.format || state.analyzing) {
+        return nullptr;
+    }
+    return state.format->Symbols(DataView(state));
+}
+
+// Move the cursor to the symbol named as typed, or else to the first one
+// starting with it.
+void GoToSymbol(HexEditorState& state) {
+    const SymbolIndex* symbols = Symbols(state);
+    if (!symbols || symbols->empty()) {
+        state.status = state.analyzing ? "Symbols are still being analyzed" : "No symbols in this file";
+        return;
+    }
+    std::optional<Symbol> symbol = symbols->Find(state.symbol_query);
+    if (!symbol) {
+        std::vector<Symbol> completions = symbols->Complete(state.symbol_query, 1);
+        if (completions.empty()) {
+            state.status = "Symbol not found: " + state.symbol_query;
+            return;
+        }
+        symbol = completions.front();
+    }
+    if (symbol->offset >= state.data.size()) {
+        state.status = std::string(symbol->name) + " is past the end of the file";
+        return;
+    }
+    MoveCursorTo(state, symbol->offset);
+    std::stringstream ss;
+    ss << symbol->name << " at 0x" << std::hex << symbol->offset << std::dec << " (" << symbol->size << " bytes)";
+    state.status = ss.str();
+}
+
+// Where the file is loaded in memory, once the analysis is done.
+const AddressMap* Addresses(HexEditorState& state) {
+    if (!state.format || state.analyzing) {
+        return nullptr;
+    }
+    return state.format->Addresses(DataView(state));
+}
+
+// A hexadecimal address, with or without its 0x prefix.
+std::optional<uint64_t> ParseAddress(std::string_view text) {
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        text.remove_prefix(2);
+    }
+    uint64_t address = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), address, 16);
+    if (text.empty() || error != std::errc() || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return address;
+}
+
+// Move the cursor to the byte loaded at the address typed.
+void GoToAddress(HexEditorState& state) {
+    const AddressMap* addresses = Addresses(state);
+    if (!addresses || addresses->empty()) {
+        state.status = state.analyzing ? "Addresses are still being analyzed" : "No virtual addresses in this file";
+        return;
+    }
+    std::optional<uint64_t> address = ParseAddress(state.address_query);
+    if (!address) {
+        state.status = "Not an address: " + state.address_query;
+        return;
+    }
+    std::optional<uint64_t> offset = addresses->OffsetOf(*address);
+    std::stringstream ss;
+    ss << "0x" << std::hex << *address;
+    if (!offset || *offset >= state.data.size()) {
+        state.status = ss.str() + " is not loaded from the file";
+        return;
+    }
+    MoveCursorTo(state, *offset);
+    ss << " at offset 0x" << *offset;
+    state.status = ss.str();
+}
+
+Color RegionColor(RegionKind kind) {
+    switch (kind) {
+        case RegionKind::Header: return Color::Blue;
+        case RegionKind::Table: return Color::Cyan;
+        case RegionKind::Code: return Color::Green;
+        case RegionKind::Data: return Color::Yellow;
+        case RegionKind::ReadOnly: return Color::GreenLight;
+        case RegionKind::Symbols: return Color::Magenta;
+        case RegionKind::Strings: return Color::BlueLight;
+        case RegionKind::Checksum: return Color::MagentaLight;
+        case RegionKind::Corrupt: return Color::RedLight;
+        case RegionKind::Other: return Color::GrayLight;
     }
-    // ELF Check
-    if (plat == Linux) {
-        state.elf_partition = HexEditorState::PartitionInfo{0, file_size - 1};
+    return Color::Default;
+}
+
+// Rows taken by everything but the data lines: outer window border (2),
+// inner border (2), column header (1) and the bordered status bar (3).
+const int layout_reserved_rows = 8;
+// Columns taken by the two borders (4), the offset column and its padding (8)
+// and the gap between the hex and ASCII panes (2).
+const int layout_reserved_cols = 14;
+
+// The address column takes its digits and its padding (2).
+const int layout_address_padding = 2;
+
+// Each byte takes "XX " in the hex pane and one cell in the ASCII pane.
+const int layout_cols_per_byte = 4;
+
+const int layout_bytes_per_line_choices[] = { 64, 32, 16, 8 };
+
+// Hex text of every byte value, so rendering a cell never formats a string.
+const std::array<std::string, 256> hex_byte_strings = [] {
+    std::array<std::string, 256> strings;
+    const char digits[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < strings.size(); ++i) {
+        strings[i] = { digits[i >> 4], digits[i & 0xf] };
     }
-    // Mach-O Check
-    if (plat == MacOS) {
-        state.mach_o_partition = HexEditorState::PartitionInfo{0, file_size - 1};
+    return strings;
+}();
+
+// Recompute the viewport for a new terminal size. The cursor keeps pointing
+// at the same byte when the number of bytes per line changes.
+void UpdateLayout(HexEditorState& state, Dimensions terminal) {
+    if (terminal.dimx == state.layout_size.dimx &&
+        terminal.dimy == state.layout_size.dimy &&
+        !state.column_header.empty()) {
+        return;
+    }
+    state.layout_size = terminal;
+
+    int reserved_cols = layout_reserved_cols;
+    if (state.address_digits) {
+        reserved_cols += state.address_digits + layout_address_padding;
     }
-    // PNG Check
-    const unsigned char png_header[] = { 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a };
-    bool is_png = true;
-    for (size_t i = 0; i < sizeof(png_header); i++) {
-        if (static_cast<unsigned char>(state.data[i]) != png_header[i]) {
-            is_png = false;
+    int bytes_per_line = layout_bytes_per_line_choices[std::size(layout_bytes_per_line_choices) - 1];
+    for (int choice : layout_bytes_per_line_choices) {
+        if (reserved_cols + choice * layout_cols_per_byte <= terminal.dimx) {
+            bytes_per_line = choice;
             break;
         }
     }
-    if (is_png) {
-        state.signuature_partition = HexEditorState::PartitionInfo{0, sizeof(png_header) - 1};
-        size_t length_chunk_start = sizeof(png_header);
-        if (file_size >= length_chunk_start + 4) {
-            state.length_chunk_partition = HexEditorState::PartitionInfo{length_chunk_start, length_chunk_start + 3};
-            size_t type_chunk_start = length_chunk_start + 4;
-            if (file_size >= type_chunk_start + 4) {
-                state.type_chunk_partition = HexEditorState::PartitionInfo{type_chunk_start, type_chunk_start + 3};
-                size_t data_chunk_start = type_chunk_start + 4;
-                if (file_size >= data_chunk_start + 4) {
-                    state.data_chunk_partition = HexEditorState::PartitionInfo{data_chunk_start, file_size - 8 - 1};
-                    state.crc_chunk_partition = HexEditorState::PartitionInfo{file_size - 8, file_size - 1};
-                }
-            }
+
+    size_t pos = state.cursor_line * state.bytes_per_line + state.cursor_col;
+    state.bytes_per_line = bytes_per_line;
+    state.cursor_line = pos / bytes_per_line;
+    state.cursor_col = static_cast<int>(pos % bytes_per_line);
+
+    state.visible_lines = static_cast<size_t>(std::max(terminal.dimy - layout_reserved_rows, 1));
+
+    state.column_header.clear();
+    for (int i = 0; i < bytes_per_line; ++i) {
+        if (i != 0) {
+            state.column_header += ' ';
         }
+        state.column_header += hex_byte_strings[i];
     }
- }
+}
+
+// Show the address column once the analysis finds where the file is loaded,
+// wide enough for its highest address. It stays while the bytes are analyzed
+// again after an edit.
+void UpdateAddressColumn(HexEditorState& state) {
+    if (state.analyzing) {
+        return;
+    }
+    const AddressMap* addresses = Addresses(state);
+    int digits = 0;
+    if (addresses && !addresses->empty()) {
+        digits = addresses->end_address() - 1 > 0xffffffff ? 16 : 8;
+    }
+    if (digits != state.address_digits) {
+        state.address_digits = digits;
+        state.column_header.clear();
+        UpdateLayout(state, state.layout_size);
+    }
+}
 
 void LoadFile(HexEditorState& state) {
     std::ifstream file(state.filename, std::ios::binary);
@@ -182,7 +418,7 @@ void SearchHex(HexEditorState& state, const std::string& query) {
         }
     }
 
-    for (size_t i = 0; i <= state.data.size() - query_bytes.size(); ++i) {
+    for (size_t i = 0; i + query_bytes.size() <= state.data.size(); ++i) {
         bool match = true;
         for (size_t j = 0; j < query_bytes.size(); ++j) {
             if (static_cast<unsigned char>(state.data[i + j]) != query_bytes[j]) {
@@ -198,8 +434,8 @@ void SearchHex(HexEditorState& state, const std::string& query) {
     state.current_search_result = 0;
     if (!state.search_results.empty()) {
         size_t pos = state.search_results[state.current_search_result];
-        state.cursor_line = pos / 16;
-        state.cursor_col = pos % 16;
+        state.cursor_line = pos / state.bytes_per_line;
+        state.cursor_col = pos % state.bytes_per_line;
     }
 }
 
@@ -207,7 +443,7 @@ void SearchAscii(HexEditorState& state, const std::string& query) {
     state.search_results.clear();
     if (query.empty()) return;
 
-    for (size_t i = 0; i <= state.data.size() - query.size(); ++i) {
+    for (size_t i = 0; i + query.size() <= state.data.size(); ++i) {
         bool match = true;
         for (size_t j = 0; j < query.size(); ++j) {
             if (state.data[i + j] != query[j]) {
@@ -223,8 +459,8 @@ void SearchAscii(HexEditorState& state, const std::string& query) {
     state.current_search_result = 0;
     if (!state.search_results.empty()) {
         size_t pos = state.search_results[state.current_search_result];
-        state.cursor_line = pos / 16;
-        state.cursor_col = pos % 16;
+        state.cursor_line = pos / state.bytes_per_line;
+        state.cursor_col = pos % state.bytes_per_line;
     }
 }
 
@@ -238,30 +474,82 @@ void Search(HexEditorState& state) {
     }
 }
 
+// Parse a pasted hex blob such as "DE AD be ef" or "0xde,0xad". Returns
+// nothing if the text contains anything else, or an odd number of digits.
+std::optional<std::vector<char>> ParseHexBlob(const std::string& text) {
+    std::vector<char> bytes;
+    int high = -1;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c)) || c == ',' || c == ':') {
+            continue;
+        }
+        if (c == '0' && high < 0 && i + 1 < text.size() && (text[i + 1] == 'x' || text[i + 1] == 'X')) {
+            ++i;
+            continue;
+        }
+        if (!std::isxdigit(static_cast<unsigned char>(c))) {
+            return std::nullopt;
+        }
+        int digit = std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : std::toupper(c) - 'A' + 10;
+        if (high < 0) {
+            high = digit;
+        } else {
+            bytes.push_back(static_cast<char>(high << 4 | digit));
+            high = -1;
+        }
+    }
+    if (high >= 0) {
+        return std::nullopt;
+    }
+    return bytes;
+}
+
+// Overwrite the bytes at the cursor with a pasted hex blob, in one go.
+void PasteHexBlob(HexEditorState& state, const std::string& text) {
+    auto bytes = ParseHexBlob(text);
+    if (!bytes) {
+        state.status = "Paste ignored: not a hex byte sequence";
+        return;
+    }
+    size_t pos = state.cursor_line * state.bytes_per_line + state.cursor_col;
+    if (bytes->empty() || pos >= state.data.size()) {
+        return;
+    }
+
+    size_t count = std::min(bytes->size(), state.data.size() - pos);
+    std::copy_n(bytes->begin(), count, state.data.begin() + pos);
+    state.status = "Pasted " + std::to_string(count) + " bytes";
+    if (count < bytes->size()) {
+        state.status += " (" + std::to_string(bytes->size() - count) + " past the end dropped)";
+    }
+
+    // Leave the cursor after the last byte written.
+    size_t next = std::min(pos + count, state.data.size() - 1);
+    state.cursor_line = next / state.bytes_per_line;
+    state.cursor_col = static_cast<int>(next % state.bytes_per_line);
+}
+
 Element RenderHexEditor(HexEditorState& state) {
     std::vector<Element> lines;
-    int bytes_per_line = 16;
+    const int bytes_per_line = state.bytes_per_line;
     size_t offset = 0;
 
-    const Color COLOR_MZ_HEADER = Color::Blue;
-    const Color COLOR_DOS_STUB = Color::Cyan;
-    const Color COLOR_PE_PARTITION = Color::Green;
-    const Color COLOR_ELF_HEADER = Color::Blue;
-    const Color COLOR_ELF_PARTITION = Color::Green;
-    const Color COLOR_MACHO_HEADER = Color::Blue;
-    const Color COLOR_MACHO_PARTITION = Color::Green;
-    const Color COLOR_PNG_SIGNATURE = Color::Blue;
-    const Color COLOR_PNG_IHDR_CHUNK = Color::Cyan;
-    const Color COLOR_PNG_IDAT_CHUNK = Color::Green;
-    const Color COLOR_PNG_IEND_CHUNK = Color::Magenta;  
     const Color COLOR_SEARCH_RESULT = Color::Yellow; 
     const Color COLOR_CURSOR = Color::Red;
 
     // Header
+    const int address_digits = state.address_digits;
+    std::string address_header;
+    if (address_digits) {
+        address_header = "Address";
+        address_header.resize(address_digits + layout_address_padding, ' ');
+    }
     lines.push_back(
         hbox({
             text("Offset  ") | bold,
-            text("00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F") | bold,
+            text(address_header) | bold,
+            text(state.column_header) | bold,
             text("  ASCII") | bold
         })
     );
@@ -275,6 +563,11 @@ Element RenderHexEditor(HexEditorState& state) {
     start_line = (start_line < total_lines) ? start_line : 0;
     size_t end_line = std::min(start_line + state.visible_lines, total_lines);
 
+    // Regions are looked up once per run of bytes they cover.
+    const RegionMap* regions = Regions(state);
+    const Region* region = nullptr;
+    const AddressMap* addresses = address_digits ? Addresses(state) : nullptr;
+
     // Data lines
     for (size_t line = start_line; line < end_line; ++line) {
         offset = line * bytes_per_line;
@@ -287,48 +580,34 @@ Element RenderHexEditor(HexEditorState& state) {
         hex_elements.push_back(text(ss.str()) | color(Color::Magenta));
         hex_elements.push_back(text("  "));
 
+        // Address column: where the first byte of the line is loaded. Blank
+        // if it isn't, or while the bytes are analyzed.
+        if (address_digits) {
+            std::string address(address_digits, ' ');
+            if (std::optional<uint64_t> loaded = addresses ? addresses->AddressOf(offset) : std::nullopt) {
+                std::stringstream as;
+                as << std::setw(address_digits) << std::setfill('0') << std::hex << *loaded;
+                address = as.str();
+            }
+            hex_elements.push_back(text(address) | color(Color::Magenta) | dim);
+            hex_elements.push_back(text(std::string(layout_address_padding, ' ')));
+        }
+
         // Hex data
         for (int i = 0; i < bytes_per_line; ++i) {
             size_t pos = offset + i;
             if (pos < state.data.size()) {
                 unsigned char byte = static_cast<unsigned char>(state.data[pos]);
-                std::string byte_str = std::format("{:02X}", byte);
-                Element byte_element = text(byte_str);
+                Element byte_element = text(hex_byte_strings[byte]);
 
                 // 检查分区并应用颜色
                 bool is_in_partition = false;
                 Color partition_color;
 
-                // MZ/PE格式分区检查
-                if (state.mz_partition && pos >= state.mz_partition->start && pos <= state.mz_partition->end) {
-                    partition_color = COLOR_MZ_HEADER;
-                    is_in_partition = true;
-                } else if (state.dos_stub_partition && pos >= state.dos_stub_partition->start && pos <= state.dos_stub_partition->end) {
-                    partition_color = COLOR_DOS_STUB;
-                    is_in_partition = true;
-                } else if (state.pe_partition && pos >= state.pe_partition->start && pos <= state.pe_partition->end) {
-                    partition_color = COLOR_PE_PARTITION;
-                    is_in_partition = true;
-                } else if (state.elf_partition && pos >= state.elf_partition->start && pos <= state.elf_partition->end) {
-                    partition_color = (pos <= 0x3F) ? COLOR_ELF_HEADER : COLOR_ELF_PARTITION;
-                    is_in_partition = true;
-                } else if (state.mach_o_partition && pos >= state.mach_o_partition->start && pos <= state.mach_o_partition->end) {
-                    partition_color = (pos <= 0x3F) ? COLOR_MACHO_HEADER : COLOR_MACHO_PARTITION;
-                    is_in_partition = true;
-                } else if (state.signuature_partition && pos >= state.signuature_partition->start && pos <= state.signuature_partition->end) {
-                    partition_color = COLOR_PNG_SIGNATURE;
-                    is_in_partition = true;
-                } else if (state.length_chunk_partition && pos >= state.length_chunk_partition->start && pos <= state.length_chunk_partition->end) {
-                    partition_color = COLOR_PNG_IHDR_CHUNK;
-                    is_in_partition = true;
-                } else if (state.type_chunk_partition && pos >= state.type_chunk_partition->start && pos <= state.type_chunk_partition->end) {
-                    partition_color = COLOR_PNG_IHDR_CHUNK;
-                    is_in_partition = true;
-                } else if (state.data_chunk_partition && pos >= state.data_chunk_partition->start && pos <= state.data_chunk_partition->end) {
-                    partition_color = COLOR_PNG_IDAT_CHUNK;
-                    is_in_partition = true;
-                } else if (state.crc_chunk_partition && pos >= state.crc_chunk_partition->start && pos <= state.crc_chunk_partition->end) {
-                    partition_color = COLOR_PNG_IEND_CHUNK;
+                // 文件格式分区检查
+                if (regions && (region = (region && pos >= region->start && pos <= region->end)
+                                                ? region : regions->Find(pos))) {
+                    partition_color = RegionColor(region->kind);
                     is_in_partition = true;
                 }
                 // Apply partition color if in partition
@@ -337,18 +616,22 @@ Element RenderHexEditor(HexEditorState& state) {
                 }
 
                 // Highlight search results
+                // Results are sorted, so only the last one starting at or
+                // before pos can cover it.
                 bool is_search_result = false;
-                for (size_t result : state.search_results) {
-                    if (pos >= result && pos < result + state.search_query.size() / 2) {
-                        is_search_result = true;
-                        break;
-                    }
+                auto result = std::upper_bound(state.search_results.begin(), state.search_results.end(), pos);
+                if (result != state.search_results.begin()) {
+                    --result;
+                    is_search_result = pos < *result + state.search_query.size() / 2;
                 }
 
-                // Highlight active byte
+                // Highlight active byte. With low bandwidth, inverting it costs
+                // fewer bytes than a background color.
                 if (line == state.cursor_line && i == state.cursor_col) {
                     if (state.edit_mode) {
                         byte_element = byte_element | color(COLOR_CURSOR);
+                    } else if (state.low_bandwidth) {
+                        byte_element = byte_element | inverted;
                     } else {
                         byte_element = byte_element | bgcolor(Color::GrayDark);
                     }
@@ -366,7 +649,11 @@ Element RenderHexEditor(HexEditorState& state) {
                     ascii_char = ascii_char | color(partition_color);
                 }
                 if (line == state.cursor_line && i == state.cursor_col) {
-                    ascii_char = ascii_char | bgcolor(Color::GrayDark);
+                    // The cursor is already shown on the hex byte; with low
+                    // bandwidth, it isn't repeated on the ASCII column.
+                    if (!state.low_bandwidth) {
+                        ascii_char = ascii_char | bgcolor(Color::GrayDark);
+                    }
                 } else if (is_search_result) {
                     ascii_char = ascii_char | bgcolor(COLOR_SEARCH_RESULT);
                 }
@@ -385,11 +672,24 @@ Element RenderHexEditor(HexEditorState& state) {
     }
 
     // Status bar
-    lines.push_back(
-        hbox({
-            text(state.status) | flex
-        }) | border
-    );
+    Elements status = {text(state.status) | flex};
+    if (state.analyzing) {
+        status.push_back(text(" analyzing " + std::to_string(state.analysis_step) + "/" +
+                              std::to_string(state.format->AnalysisSteps()) + " ") | dim);
+    }
+    if (regions) {
+        size_t pos = state.cursor_line * bytes_per_line + state.cursor_col;
+        if (const Region* current = regions->Find(pos)) {
+            status.push_back(text(" " + current->name + " ") | color(RegionColor(current->kind)));
+        }
+    }
+    if (state.link_congested) {
+        status.push_back(text(" link congested ") | inverted | color(Color::Yellow));
+    }
+    if (state.debug_bytes) {
+        status.push_back(text(" " + std::to_string(state.last_frame_bytes) + " B/frame"));
+    }
+    lines.push_back(hbox(std::move(status)) | border);
 
     return window(
         text("Hex Editor") | hcenter | bold,
@@ -413,11 +713,70 @@ Element RenderSearchWindow(HexEditorState& state) {
     );
 }
 
+// Symbols starting with the query are listed under it.
+const size_t symbol_completions = 10;
+
+Element RenderSymbolPrompt(HexEditorState& state) {
+    Elements lines = {
+        hbox({
+            text("Symbol: "),
+            text(state.symbol_query + "|")
+        })
+    };
+    if (const SymbolIndex* symbols = Symbols(state)) {
+        for (const Symbol& symbol : symbols->Complete(state.symbol_query, symbol_completions)) {
+            std::stringstream ss;
+            ss << "0x" << std::hex << symbol.offset;
+            lines.push_back(hbox({
+                text(std::string(symbol.name)) | flex,
+                text(" " + ss.str()) | color(Color::GrayLight)
+            }));
+        }
+    } else if (state.analyzing) {
+        lines.push_back(text("Analyzing...") | dim);
+    }
+
+    return window(
+        text("Go to Symbol") | hcenter | bold,
+        vbox(std::move(lines)) | border
+    );
+}
+
+Element RenderAddressPrompt(HexEditorState& state) {
+    Elements lines = {
+        hbox({
+            text("Address: "),
+            text(state.address_query + "|")
+        })
+    };
+    // Where the address typed so far is in the file
+    const AddressMap* addresses = Addresses(state);
+    std::optional<uint64_t> address = ParseAddress(state.address_query);
+    if (addresses && address) {
+        if (std::optional<uint64_t> offset = addresses->OffsetOf(*address)) {
+            std::stringstream ss;
+            ss << "offset 0x" << std::hex << *offset;
+            lines.push_back(text(ss.str()) | color(Color::GrayLight));
+        } else {
+            lines.push_back(text("not loaded from the file") | dim);
+        }
+    } else if (state.analyzing) {
+        lines.push_back(text("Analyzing...") | dim);
+    }
+
+    return window(
+        text("Go to Address") | hcenter | bold,
+        vbox(std::move(lines)) | border
+    );
+}
+
 const char* options[] = {
-    "--no-light"
+    "--no-light",
+    "--low-bandwidth",
+    "--debug-bytes"
 };
 
-const int options_num = 1;
+const int options_num = 3;
 
 bool is_light = true;
 
@@ -428,6 +787,8 @@ int main(int argc, char* argv[]) {
         std::cout << "Usage: " << argv[0] << " [-OPTIONS] <filename>\n";
         std::cout << "-OPTIONS:" << std::endl;
         std::cout << "  --no-light: Disable highlight support" << std::endl;
+        std::cout << "  --low-bandwidth: Reduce the output, for slow remote links" << std::endl;
+        std::cout << "  --debug-bytes: Show the bytes sent per frame" << std::endl;
         return 1;
     }
     HexEditorState state;
@@ -443,6 +804,16 @@ int main(int argc, char* argv[]) {
                     is_light = false;
                     break;
 
+                    // Reduce the output for slow links
+                case 1:
+                    state.low_bandwidth = true;
+                    break;
+
+                    // Show the bytes sent per frame
+                case 2:
+                    state.debug_bytes = true;
+                    break;
+
                 default:
                     break;
                 }
@@ -461,6 +832,8 @@ int main(int argc, char* argv[]) {
         std::cout << "Usage: " << argv[0] << "[-OPTIONS] <filename>\n";
         std::cout << "-OPTIONS:" << std::endl;
         std::cout << "  --no-light: Disable highlight support" << std::endl;
+        std::cout << "  --low-bandwidth: Reduce the output, for slow remote links" << std::endl;
+        std::cout << "  --debug-bytes: Show the bytes sent per frame" << std::endl;
         return 1;
     }
 
@@ -469,20 +842,52 @@ int main(int argc, char* argv[]) {
     LoadFile(state);
 
     if (is_light) {
-        DetermineExecutablePartitions(state);
+        DetectFormat(state);
+    }
+
+    if (state.low_bandwidth) {
+        // Colors are downgraded when created, this must come first.
+        if (Terminal::ColorSupport() > Terminal::Color::Palette16) {
+            Terminal::SetColorSupport(Terminal::Color::Palette16);
+        }
     }
 
     auto screen = ScreenInteractive::Fullscreen();
+    // Held arrow keys draw at most one frame per display interval.
+    screen.SetMaxFPS(60);
+    // Pasted text arrives as a single event.
+    screen.TrackPaste();
+    screen.SetLowBandwidth(state.low_bandwidth);
     auto component = Renderer([&] {
+        state.link_congested = screen.IsCongested();
+        state.last_frame_bytes = screen.LastFrameSize();
+        UpdateAddressColumn(state);
         if (state.search_window_open) {
             return RenderSearchWindow(state);
+        } else if (state.symbol_prompt_open) {
+            return RenderSymbolPrompt(state);
+        } else if (state.address_prompt_open) {
+            return RenderAddressPrompt(state);
         } else {
             return RenderHexEditor(state);
         }
     });
 
+    UpdateLayout(state, Terminal::Size());
+
     component |= CatchEvent([&](Event event) {
-        int bytes_per_line = 16;
+        // Terminal resize, posted by ScreenInteractive on SIGWINCH.
+        if (event == Event::Special({0})) {
+            UpdateLayout(state, Terminal::Size());
+            return false;
+        }
+        // Exits the loop: the worker must not post to it anymore.
+        if (event == Event::CtrlC) {
+            StopAnalysis(state);
+            return false;
+        }
+
+        const int bytes_per_line = state.bytes_per_line;
         size_t total_lines = (state.data.size() + bytes_per_line - 1) / bytes_per_line;
         if (state.search_window_open) {
             if (event == Event::Backspace && state.search_cursor > 0) {
@@ -508,10 +913,19 @@ int main(int argc, char* argv[]) {
                 if (!input.empty()) {
                     // char c = input[0];
                     state.search_query.insert(state.search_cursor, input);
-                    state.search_cursor++;
+                    state.search_cursor += input.size();
                 }
                 return true;
             }
+
+            // A pasted query is inserted at once. It is a single line.
+            if (event.is_paste()) {
+                std::string input = event.paste();
+                input.erase(std::remove(input.begin(), input.end(), '\n'), input.end());
+                state.search_query.insert(state.search_cursor, input);
+                state.search_cursor += input.size();
+                return true;
+            }
             
             if (event == Event::Return) {
                 Search(state);
@@ -531,6 +945,70 @@ int main(int argc, char* argv[]) {
             return false;
         }
 
+        if (state.symbol_prompt_open) {
+            if (event == Event::Backspace && !state.symbol_query.empty()) {
+                state.symbol_query.pop_back();
+                return true;
+            }
+            // Complete to the first symbol starting with the query
+            if (event == Event::Tab) {
+                if (const SymbolIndex* symbols = Symbols(state)) {
+                    std::vector<Symbol> completions = symbols->Complete(state.symbol_query, 1);
+                    if (!completions.empty()) {
+                        state.symbol_query = std::string(completions.front().name);
+                    }
+                }
+                return true;
+            }
+            if (event.is_character()) {
+                state.symbol_query += event.character();
+                return true;
+            }
+            if (event.is_paste()) {
+                std::string input = event.paste();
+                input.erase(std::remove(input.begin(), input.end(), '\n'), input.end());
+                state.symbol_query += input;
+                return true;
+            }
+            if (event == Event::Return) {
+                GoToSymbol(state);
+                state.symbol_prompt_open = false;
+                return true;
+            }
+            if (event == Event::Escape) {
+                state.symbol_prompt_open = false;
+                return true;
+            }
+            return false;
+        }
+
+        if (state.address_prompt_open) {
+            if (event == Event::Backspace && !state.address_query.empty()) {
+                state.address_query.pop_back();
+                return true;
+            }
+            if (event.is_character()) {
+                state.address_query += event.character();
+                return true;
+            }
+            if (event.is_paste()) {
+                std::string input = event.paste();
+                input.erase(std::remove(input.begin(), input.end(), '\n'), input.end());
+                state.address_query += input;
+                return true;
+            }
+            if (event == Event::Return) {
+                GoToAddress(state);
+                state.address_prompt_open = false;
+                return true;
+            }
+            if (event == Event::Escape) {
+                state.address_prompt_open = false;
+                return true;
+            }
+            return false;
+        }
+
         // Navigation
         if (event == Event::ArrowUp && state.cursor_line > 0) {
             state.cursor_line--;
@@ -572,7 +1050,9 @@ int main(int argc, char* argv[]) {
                             unsigned int byte = std::stoul(state.edit_buffer, nullptr, 16);
                             size_t pos = state.cursor_line * bytes_per_line + state.cursor_col;
                             if (pos < state.data.size()) {
+                                StopAnalysis(state);
                                 state.data[pos] = static_cast<char>(byte);
+                                StartAnalysis(state, screen, analysis_restart_delay);
                             }
                         } catch (...) {}
 
@@ -588,6 +1068,16 @@ int main(int argc, char* argv[]) {
             return true;
         }
 
+        // Paste a hex blob over the bytes at the cursor
+        if (event.is_paste()) {
+            state.edit_mode = false;
+            state.edit_buffer.clear();
+            StopAnalysis(state);
+            PasteHexBlob(state, event.paste());
+            StartAnalysis(state, screen, analysis_restart_delay);
+            return true;
+        }
+
         // Cancel edit
         if (state.edit_mode && event == Event::Escape) {
             state.edit_mode = false;
@@ -603,6 +1093,7 @@ int main(int argc, char* argv[]) {
 
         // Quit program
         if (event == Event::CtrlQ) {
+            StopAnalysis(state);
             screen.ExitLoopClosure()();
             return true;
         }
@@ -616,27 +1107,53 @@ int main(int argc, char* argv[]) {
             return true;
         }
 
+        // Go to symbol
+        if (event == Event::CtrlG) {
+            state.symbol_prompt_open = true;
+            state.symbol_query.clear();
+            return true;
+        }
+
+        // Go to virtual address
+        if (event == Event::CtrlA) {
+            state.address_prompt_open = true;
+            state.address_query.clear();
+            return true;
+        }
+
+        // Next / previous region of the file format
+        if (event == Event::Tab) {
+            JumpToRegion(state, true);
+            return true;
+        }
+        if (event == Event::TabReverse) {
+            JumpToRegion(state, false);
+            return true;
+        }
+
         // Next search result
         if (event == Event::PageDown && !state.search_results.empty()) {
             state.current_search_result = (state.current_search_result + 1) % state.search_results.size();
             size_t pos = state.search_results[state.current_search_result];
-            state.cursor_line = pos / 16;
-            state.cursor_col = pos % 16;
+            state.cursor_line = pos / state.bytes_per_line;
+            state.cursor_col = pos % state.bytes_per_line;
             return true;
         }
         // Pre search result
         if (event == Event::PageUp && !state.search_results.empty()) {
             state.current_search_result = (state.current_search_result - 1) % state.search_results.size();
             size_t pos = state.search_results[state.current_search_result];
-            state.cursor_line = pos / 16;
-            state.cursor_col = pos % 16;
+            state.cursor_line = pos / state.bytes_per_line;
+            state.cursor_col = pos % state.bytes_per_line;
             return true;
         }
 
         if (event == Event::Delete) {
             size_t pos = state.cursor_line * bytes_per_line + state.cursor_col;
             if (pos < state.data.size()) {
+                StopAnalysis(state);
                 state.data.erase(state.data.begin() + pos);
+                StartAnalysis(state, screen, analysis_restart_delay);
                 total_lines = (state.data.size() + bytes_per_line - 1) / bytes_per_line;
                 if (state.cursor_col == bytes_per_line - 1 && state.cursor_line > 0) {
                     state.cursor_line--;
@@ -655,7 +1172,9 @@ int main(int argc, char* argv[]) {
         if (event == Event::Insert) {
             size_t pos = state.cursor_line * bytes_per_line + state.cursor_col;
             if (pos < state.data.size()) {
+                StopAnalysis(state);
                 state.data.insert(state.data.begin() + pos, 0);
+                StartAnalysis(state, screen, analysis_restart_delay);
                 total_lines = (state.data.size() + bytes_per_line - 1) / bytes_per_line;
                 if (state.cursor_col == bytes_per_line - 1 && state.cursor_line > 0) {
                     state.cursor_line--;
@@ -674,6 +1193,10 @@ int main(int argc, char* argv[]) {
         return false;
     });
 
-    screen.Loop(component);
+    // Posting to the screen needs its loop to be installed.
+    Loop loop(&screen, component);
+    StartAnalysis(state, screen);
+    loop.Run();
+    StopAnalysis(state);
     return 0;
 }
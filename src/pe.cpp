@@ -0,0 +1,325 @@
+#include "pe.hpp"
+
+#include "byte_reader.hpp"
+
+#include <algorithm>
+
+namespace {
+
+const size_t dos_header_size = 0x40;
+const size_t e_lfanew_offset = 0x3c;
+const size_t coff_header_size = 20;
+const size_t section_header_size = 40;
+const size_t import_descriptor_size = 20;
+const size_t coff_symbol_size = 18;
+// Longer names are cut, corrupted tables don't read the whole file.
+const size_t max_name_size = 256;
+
+// Optional header magic
+const uint16_t pe32_magic = 0x10b;
+const uint16_t pe32_plus_magic = 0x20b;
+
+// Section characteristics
+const uint32_t scn_cnt_code = 0x00000020;
+const uint32_t scn_cnt_uninitialized_data = 0x00000080;
+const uint32_t scn_mem_execute = 0x20000000;
+const uint32_t scn_mem_write = 0x80000000;
+
+// Data directory indexes
+const size_t directory_export = 0;
+const size_t directory_import = 1;
+const size_t directory_security = 4;
+const size_t directory_count = 16;
+
+const char* const directory_names[directory_count] = {
+    "export directory",
+    "import directory",
+    "resource directory",
+    "exception directory",
+    "certificate table",
+    "base relocations",
+    "debug directory",
+    "architecture",
+    "global pointer",
+    "TLS directory",
+    "load config",
+    "bound imports",
+    "import address table",
+    "delay imports",
+    "CLR header",
+    "reserved directory",
+};
+
+RegionKind DirectoryKind(size_t index) {
+    switch (index) {
+        case 0:   // export
+        case 1:   // import
+        case 11:  // bound import
+        case 12:  // import address table
+        case 13:  // delay import
+            return RegionKind::Symbols;
+        case 2:   // resource
+        case 4:   // certificate
+        case 6:   // debug
+            return RegionKind::Other;
+        default:
+            return RegionKind::Table;
+    }
+}
+
+RegionKind SectionKind(const PeSection& section) {
+    if (section.characteristics & (scn_cnt_code | scn_mem_execute)) {
+        return RegionKind::Code;
+    }
+    if (section.characteristics & scn_mem_write) {
+        return RegionKind::Data;
+    }
+    return RegionKind::ReadOnly;
+}
+
+// Section names are padded to 8 bytes. Object files store longer ones in the
+// COFF string table, as "/<decimal offset>".
+std::string SectionName(const ByteReader& reader, uint64_t offset, uint64_t string_table) {
+    std::string name = reader.String(offset, offset + 8);
+    if (name.size() < 2 || name[0] != '/' || string_table == 0 ||
+        !std::all_of(name.begin() + 1, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return name;
+    }
+    uint64_t name_offset = string_table + std::stoull(name.substr(1));
+    if (!reader.Has(name_offset, 1)) {
+        return name;
+    }
+    return reader.String(name_offset, name_offset + max_name_size);
+}
+
+void ParseHeaders(const ByteReader& reader, PeLayout& layout, std::vector<Region>& regions) {
+    const size_t file_size = reader.size();
+    uint64_t pe_offset = reader.U32(e_lfanew_offset);
+    if (pe_offset < dos_header_size || !reader.Has(pe_offset, 4 + coff_header_size) ||
+        reader.U32(pe_offset) != 0x00004550) {  // "PE\0\0"
+        // A DOS program: everything after its header is code.
+        if (auto region = ClippedRegion(dos_header_size, file_size, file_size,
+                                        "DOS program", RegionKind::Code)) {
+            regions.push_back(*region);
+        }
+        return;
+    }
+    if (auto region = ClippedRegion(dos_header_size, pe_offset - dos_header_size, file_size,
+                                    "DOS stub", RegionKind::Other)) {
+        regions.push_back(*region);
+    }
+
+    PeHeader header = {};
+    header.pe_offset = pe_offset;
+    const uint64_t coff = pe_offset + 4;
+    header.machine = reader.U16(coff);
+    header.section_count = reader.U16(coff + 2);
+    const uint32_t symbol_table = reader.U32(coff + 8);
+    const uint32_t symbol_count = reader.U32(coff + 12);
+    header.optional_header_size = reader.U16(coff + 16);
+    header.characteristics = reader.U16(coff + 18);
+    regions.push_back(*ClippedRegion(pe_offset, 4, file_size, "PE signature", RegionKind::Header));
+    regions.push_back(*ClippedRegion(coff, coff_header_size, file_size, "COFF header", RegionKind::Header));
+
+    // Optional header, with the data directories at its end.
+    const uint64_t optional = coff + coff_header_size;
+    const uint64_t optional_size = header.optional_header_size;
+    if (auto region = ClippedRegion(optional, optional_size, file_size,
+                                    "optional header", RegionKind::Header)) {
+        regions.push_back(*region);
+    }
+    auto has_field = [&](uint64_t field, uint64_t size) {
+        return field + size <= optional_size && reader.Has(optional + field, size);
+    };
+    if (has_field(0, 2)) {
+        const uint16_t magic = reader.U16(optional);
+        header.is_64 = magic == pe32_plus_magic;
+        if (magic == pe32_magic || magic == pe32_plus_magic) {
+            if (has_field(16, 4)) {
+                header.entry_point = reader.U32(optional + 16);
+            }
+            if (header.is_64 ? has_field(24, 8) : has_field(28, 4)) {
+                header.image_base = header.is_64 ? reader.U64(optional + 24) : reader.U32(optional + 28);
+            }
+            if (has_field(60, 4)) {
+                header.size_of_headers = reader.U32(optional + 60);
+            }
+            const uint64_t count_field = header.is_64 ? 108 : 92;
+            const uint64_t directories = count_field + 4;
+            if (has_field(count_field, 4)) {
+                uint64_t count = std::min<uint64_t>(reader.U32(optional + count_field), directory_count);
+                for (uint64_t i = 0; i < count && has_field(directories + i * 8, 8); ++i) {
+                    const uint64_t entry = optional + directories + i * 8;
+                    layout.directories.push_back({ reader.U32(entry), reader.U32(entry + 4), std::nullopt });
+                }
+                if (auto region = ClippedRegion(optional + directories, layout.directories.size() * 8,
+                                                file_size, "data directories", RegionKind::Table)) {
+                    regions.push_back(*region);
+                }
+            }
+        }
+    }
+
+    // Section table
+    const uint64_t string_table = symbol_table != 0
+        ? symbol_table + uint64_t(symbol_count) * coff_symbol_size : 0;
+    const uint64_t table = optional + optional_size;
+    for (uint64_t i = 0; i < header.section_count; ++i) {
+        const uint64_t entry = table + i * section_header_size;
+        if (!reader.Has(entry, section_header_size)) {
+            break;
+        }
+        PeSection section;
+        section.name = SectionName(reader, entry, string_table);
+        section.virtual_size = reader.U32(entry + 8);
+        section.virtual_address = reader.U32(entry + 12);
+        section.raw_size = reader.U32(entry + 16);
+        section.raw_offset = reader.U32(entry + 20);
+        section.characteristics = reader.U32(entry + 36);
+        layout.sections.push_back(section);
+    }
+    if (auto region = ClippedRegion(table, layout.sections.size() * section_header_size, file_size,
+                                    "section headers", RegionKind::Table)) {
+        regions.push_back(*region);
+    }
+    layout.header = header;
+}
+
+void ParseDirectories(const ByteReader& reader, PeLayout& layout, std::vector<Region>& regions) {
+    const size_t file_size = reader.size();
+    for (size_t i = 0; i < layout.directories.size(); ++i) {
+        PeDataDirectory& directory = layout.directories[i];
+        if (directory.rva == 0 || directory.size == 0) {
+            continue;
+        }
+        // The certificate table is the only one not loaded: it has a file offset.
+        directory.offset = i == directory_security ? std::optional<uint64_t>(directory.rva)
+                                                   : PeRvaToOffset(layout, directory.rva);
+        if (!directory.offset) {
+            continue;
+        }
+        if (auto region = ClippedRegion(*directory.offset, directory.size, file_size,
+                                        directory_names[i], DirectoryKind(i))) {
+            regions.push_back(*region);
+        }
+    }
+
+    // Names of the imported DLLs. The descriptor table ends with a null entry.
+    if (directory_import < layout.directories.size() && layout.directories[directory_import].offset) {
+        const PeDataDirectory& directory = layout.directories[directory_import];
+        const uint64_t end = *directory.offset + directory.size;
+        for (uint64_t entry = *directory.offset;
+             entry < end && reader.Has(entry, import_descriptor_size); entry += import_descriptor_size) {
+            const uint32_t name_rva = reader.U32(entry + 12);
+            if (name_rva == 0 && reader.U32(entry) == 0 && reader.U32(entry + 16) == 0) {
+                break;
+            }
+            auto name = PeRvaToOffset(layout, name_rva);
+            if (!name || !reader.Has(*name, 1)) {
+                continue;
+            }
+            PeImport import{ reader.String(*name, *name + max_name_size), entry };
+            if (auto region = ClippedRegion(*name, import.dll.size() + 1, file_size,
+                                            "import " + import.dll, RegionKind::Strings)) {
+                regions.push_back(*region);
+            }
+            layout.imports.push_back(std::move(import));
+        }
+    }
+
+    // Name of the DLL, from the export directory.
+    if (directory_export < layout.directories.size() && layout.directories[directory_export].offset) {
+        const uint64_t entry = *layout.directories[directory_export].offset;
+        if (reader.Has(entry, 16)) {
+            auto name = PeRvaToOffset(layout, reader.U32(entry + 12));
+            if (name && reader.Has(*name, 1)) {
+                layout.export_name = reader.String(*name, *name + max_name_size);
+                if (auto region = ClippedRegion(*name, layout.export_name.size() + 1, file_size,
+                                                "export " + layout.export_name, RegionKind::Strings)) {
+                    regions.push_back(*region);
+                }
+            }
+        }
+    }
+}
+
+// The headers and the sections, at the image base plus their RVA. The raw
+// data is rounded up to the file alignment: only the virtual size is loaded.
+void MapSections(PeLayout& layout) {
+    if (!layout.header) {
+        return;
+    }
+    const uint64_t image_base = layout.header->image_base;
+    layout.addresses.Add(0, image_base, layout.header->size_of_headers);
+    for (const PeSection& section : layout.sections) {
+        if (section.raw_offset == 0 || (section.characteristics & scn_cnt_uninitialized_data)) {
+            continue;
+        }
+        const uint32_t size = section.virtual_size ? std::min(section.raw_size, section.virtual_size)
+                                                   : section.raw_size;
+        layout.addresses.Add(section.raw_offset, image_base + section.virtual_address, size);
+    }
+    layout.addresses.Finish();
+}
+
+std::optional<PeLayout> ParsePe(std::string_view data, bool with_directories) {
+    if (!IsMz(data)) {
+        return std::nullopt;
+    }
+    PeLayout layout;
+    ByteReader reader(data);
+    std::vector<Region> regions;
+    regions.push_back(*ClippedRegion(0, dos_header_size, data.size(), "MZ header", RegionKind::Header));
+    if (reader.Has(0, dos_header_size)) {
+        ParseHeaders(reader, layout, regions);
+    }
+
+    // Sections are loaded from their raw data. Uninitialized data has none.
+    for (const PeSection& section : layout.sections) {
+        if (section.raw_offset == 0 || (section.characteristics & scn_cnt_uninitialized_data)) {
+            continue;
+        }
+        std::string name = section.name.empty() ? "section" : section.name;
+        if (auto region = ClippedRegion(section.raw_offset, section.raw_size, data.size(),
+                                        std::move(name), SectionKind(section))) {
+            regions.push_back(*region);
+        }
+    }
+    MapSections(layout);
+    if (with_directories) {
+        ParseDirectories(reader, layout, regions);
+    }
+    layout.regions.PaintNested(std::move(regions));
+    return layout;
+}
+
+}  // namespace
+
+bool IsMz(std::string_view data) {
+    return data.size() >= 2 && data[0] == 'M' && data[1] == 'Z';
+}
+
+std::optional<PeLayout> ParsePeLayout(std::string_view data) {
+    return ParsePe(data, true);
+}
+
+std::optional<PeLayout> ParsePeSections(std::string_view data) {
+    return ParsePe(data, false);
+}
+
+std::optional<uint64_t> PeRvaToOffset(const PeLayout& layout, uint64_t rva) {
+    if (layout.header && rva < layout.header->size_of_headers) {
+        return rva;
+    }
+    for (const PeSection& section : layout.sections) {
+        const uint64_t start = section.virtual_address;
+        const uint64_t size = std::max(section.virtual_size, section.raw_size);
+        if (rva >= start && rva - start < size) {
+            if (rva - start >= section.raw_size) {
+                return std::nullopt;  // Zero-filled when loaded.
+            }
+            return section.raw_offset + (rva - start);
+        }
+    }
+    return std::nullopt;
+}
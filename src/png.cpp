@@ -0,0 +1,178 @@
+#include "png.hpp"
+
+#include "byte_reader.hpp"
+#include "crc32.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+namespace {
+
+const unsigned char png_signature[] = { 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a };
+
+// Length and type before the data, CRC after it.
+const size_t chunk_header_size = 8;
+const size_t chunk_crc_size = 4;
+// Lengths are limited to 2^31 - 1 by the specification.
+const uint32_t max_chunk_length = 0x7fffffff;
+
+// Below this, starting threads costs more than it saves.
+const uint64_t parallel_crc_threshold = 4 << 20;
+// Large chunks (often a single IDAT) are split, and the CRCs of the pieces
+// combined, so that they are verified in parallel too.
+const uint64_t crc_piece_size = 1 << 20;
+
+RegionKind ChunkDataKind(const std::string& type) {
+    if (type == "IDAT" || type == "fdAT") {
+        return RegionKind::Data;
+    }
+    if (type == "tEXt" || type == "zTXt" || type == "iTXt") {
+        return RegionKind::Strings;
+    }
+    if (type == "IHDR" || type == "PLTE" || type == "IEND" || type == "acTL" || type == "fcTL") {
+        return RegionKind::Header;
+    }
+    return RegionKind::Other;
+}
+
+// A run of bytes covered by a chunk CRC: its type and data.
+struct CrcPiece {
+    size_t chunk;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t crc;
+};
+
+void VerifyChunks(std::string_view data, std::vector<PngChunk>& chunks, const std::atomic<bool>* cancel) {
+    std::vector<CrcPiece> pieces;
+    uint64_t total = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (chunks[i].truncated) {
+            continue;
+        }
+        const uint64_t start = chunks[i].offset + 4;
+        const uint64_t size = uint64_t(chunks[i].length) + 4;
+        for (uint64_t offset = 0; offset < size; offset += crc_piece_size) {
+            pieces.push_back({ i, start + offset, std::min(crc_piece_size, size - offset), 0 });
+        }
+        total += size;
+    }
+
+    std::atomic<size_t> next{0};
+    auto verify = [&] {
+        for (size_t i; !Cancelled(cancel) && (i = next.fetch_add(1, std::memory_order_relaxed)) < pieces.size();) {
+            pieces[i].crc = Crc32(data.data() + pieces[i].offset, pieces[i].size);
+        }
+    };
+    const size_t workers = std::min<size_t>(std::thread::hardware_concurrency(), pieces.size());
+    std::vector<std::thread> threads;
+    if (total >= parallel_crc_threshold) {
+        for (size_t i = 1; i < workers; ++i) {
+            threads.emplace_back(verify);
+        }
+    }
+    verify();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (Cancelled(cancel)) {
+        return;
+    }
+
+    // The pieces of a chunk are in order.
+    ByteReader reader(data, true);
+    for (size_t i = 0; i < pieces.size();) {
+        PngChunk& chunk = chunks[pieces[i].chunk];
+        const size_t index = pieces[i].chunk;
+        uint32_t crc = pieces[i].crc;
+        for (++i; i < pieces.size() && pieces[i].chunk == index; ++i) {
+            crc = Crc32Combine(crc, pieces[i].crc, pieces[i].size);
+        }
+        chunk.crc_ok = crc == reader.U32(chunk.offset + chunk_header_size + chunk.length);
+    }
+}
+
+// Nothing once cancelled, as CRCs may be left unverified.
+std::optional<PngLayout> ParsePng(std::string_view data, bool verify, const std::atomic<bool>* cancel) {
+    if (!IsPng(data)) {
+        return std::nullopt;
+    }
+    PngLayout layout;
+    ByteReader reader(data, true);
+    uint64_t offset = sizeof(png_signature);
+    while (reader.Has(offset, chunk_header_size) && !Cancelled(cancel)) {
+        PngChunk chunk;
+        chunk.offset = offset;
+        chunk.length = reader.U32(offset);
+        chunk.type = std::string(data.substr(offset + 4, 4));
+        chunk.crc_ok = false;
+        chunk.truncated = chunk.length > max_chunk_length ||
+                          !reader.Has(offset + chunk_header_size, uint64_t(chunk.length) + chunk_crc_size);
+        layout.chunks.push_back(chunk);
+        if (chunk.truncated || chunk.type == "IEND") {
+            break;
+        }
+        offset += chunk_header_size + chunk.length + chunk_crc_size;
+    }
+    if (verify) {
+        VerifyChunks(data, layout.chunks, cancel);
+    }
+    if (Cancelled(cancel)) {
+        return std::nullopt;
+    }
+
+    std::vector<Region> regions;
+    regions.push_back(*ClippedRegion(0, sizeof(png_signature), data.size(),
+                                     "PNG signature", RegionKind::Header));
+    uint64_t end = sizeof(png_signature);
+    for (const PngChunk& chunk : layout.chunks) {
+        const bool bad_crc = verify && !chunk.crc_ok;
+        const bool corrupt = chunk.truncated || bad_crc;
+        const std::string suffix = chunk.truncated ? " (truncated)" : bad_crc ? " (bad CRC)" : "";
+        if (corrupt) {
+            ++layout.corrupt_chunks;
+        }
+        const uint64_t data_offset = chunk.offset + chunk_header_size;
+        if (auto region = ClippedRegion(chunk.offset, chunk_header_size, data.size(), chunk.type + " header" + suffix,
+                                        corrupt ? RegionKind::Corrupt : RegionKind::Table)) {
+            regions.push_back(*region);
+        }
+        if (auto region = ClippedRegion(data_offset, chunk.length, data.size(), chunk.type + suffix,
+                                        corrupt ? RegionKind::Corrupt : ChunkDataKind(chunk.type))) {
+            regions.push_back(*region);
+        }
+        if (auto region = ClippedRegion(data_offset + chunk.length, chunk_crc_size, data.size(),
+                                        chunk.type + " CRC" + suffix,
+                                        corrupt ? RegionKind::Corrupt : RegionKind::Checksum)) {
+            regions.push_back(*region);
+        }
+        end = data_offset + chunk.length + chunk_crc_size;
+    }
+    if (auto region = ClippedRegion(end, data.size() - std::min<uint64_t>(end, data.size()), data.size(),
+                                    "trailing data", RegionKind::Other)) {
+        regions.push_back(*region);
+    }
+    // Chunks don't overlap: the order doesn't matter.
+    for (const Region& region : regions) {
+        layout.regions.Paint(region);
+    }
+    return layout;
+}
+
+}  // namespace
+
+bool IsPng(std::string_view data) {
+    return data.size() >= sizeof(png_signature) &&
+           std::equal(std::begin(png_signature), std::end(png_signature),
+                      reinterpret_cast<const unsigned char*>(data.data()));
+}
+
+std::optional<PngLayout> ParsePngLayout(std::string_view data, const std::atomic<bool>* cancel) {
+    return ParsePng(data, true, cancel);
+}
+
+std::optional<PngLayout> ParsePngChunks(std::string_view data, const std::atomic<bool>* cancel) {
+    return ParsePng(data, false, cancel);
+}
@@ -0,0 +1,82 @@
+#include "region.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+void RegionMap::Paint(const Region& region) {
+    if (region.start > region.end) {
+        return;
+    }
+
+    // Cut the region overlapping the first byte, keeping its head.
+    auto it = regions_.lower_bound(region.start);
+    if (it != regions_.begin()) {
+        auto previous = std::prev(it);
+        if (previous->second.end >= region.start) {
+            Region head = previous->second;
+            head.end = region.start - 1;
+            if (previous->second.end > region.end) {
+                // The new region is inside it: keep its tail too.
+                Region tail = previous->second;
+                tail.start = region.end + 1;
+                regions_.emplace(tail.start, tail);
+            }
+            previous->second = head;
+        }
+    }
+
+    // Drop the regions fully covered, and cut the last one keeping its tail.
+    while (it != regions_.end() && it->first <= region.end) {
+        if (it->second.end > region.end) {
+            Region tail = it->second;
+            tail.start = region.end + 1;
+            regions_.erase(it);
+            regions_.emplace(tail.start, tail);
+            break;
+        }
+        it = regions_.erase(it);
+    }
+
+    regions_[region.start] = region;
+}
+
+void RegionMap::PaintNested(std::vector<Region> regions) {
+    std::stable_sort(regions.begin(), regions.end(), [](const Region& a, const Region& b) {
+        return a.end - a.start > b.end - b.start;
+    });
+    for (const Region& region : regions) {
+        Paint(region);
+    }
+}
+
+const Region* RegionMap::Find(size_t pos) const {
+    auto it = regions_.upper_bound(pos);
+    if (it == regions_.begin()) {
+        return nullptr;
+    }
+    --it;
+    return pos <= it->second.end ? &it->second : nullptr;
+}
+
+const Region* RegionMap::Next(size_t pos) const {
+    auto it = regions_.upper_bound(pos);
+    return it != regions_.end() ? &it->second : nullptr;
+}
+
+const Region* RegionMap::Previous(size_t pos) const {
+    auto it = regions_.lower_bound(pos);
+    if (it == regions_.begin()) {
+        return nullptr;
+    }
+    return &std::prev(it)->second;
+}
+
+std::optional<Region> ClippedRegion(uint64_t offset, uint64_t size, size_t file_size,
+                                    std::string name, RegionKind kind) {
+    if (size == 0 || offset >= file_size) {
+        return std::nullopt;
+    }
+    size = std::min<uint64_t>(size, file_size - offset);
+    return Region{ static_cast<size_t>(offset), static_cast<size_t>(offset + size - 1),
+                   std::move(name), kind };
+}
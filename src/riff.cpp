@@ -0,0 +1,147 @@
+#include "riff.hpp"
+
+#include "byte_reader.hpp"
+
+namespace {
+
+const size_t chunk_header_size = 8;
+// Crafted files can't nest lists deep enough to exhaust the stack.
+const int max_depth = 16;
+// A chunk size whose value is in the ds64 chunk of an RF64 file.
+const uint32_t rf64_saturated = 0xffffffff;
+
+RegionKind ChunkKind(const RiffChunk& chunk, const std::string& parent_list) {
+    if (chunk.id == "RIFF" || chunk.id == "RF64" || chunk.id == "LIST") {
+        return chunk.list_type == "movi" ? RegionKind::Data : RegionKind::Table;
+    }
+    if (parent_list == "INFO") {
+        return RegionKind::Strings;
+    }
+    if (chunk.id == "fmt " || chunk.id == "ds64" || chunk.id == "avih" || chunk.id == "strh" ||
+        chunk.id == "strf" || chunk.id == "VP8X" || chunk.id == "ANIM") {
+        return RegionKind::Header;
+    }
+    if (chunk.id == "data" || chunk.id == "VP8 " || chunk.id == "VP8L" || chunk.id == "ALPH" ||
+        chunk.id == "ANMF") {
+        return RegionKind::Data;
+    }
+    if (chunk.id == "idx1" || chunk.id == "indx") {
+        return RegionKind::Table;
+    }
+    return RegionKind::Other;
+}
+
+// Chunk identifiers are padded with spaces.
+std::string ChunkName(const RiffChunk& chunk) {
+    std::string name = chunk.id;
+    name.erase(name.find_last_not_of(' ') + 1);
+    if (!chunk.list_type.empty()) {
+        std::string type = chunk.list_type;
+        type.erase(type.find_last_not_of(' ') + 1);
+        name += " " + type;
+    }
+    return name;
+}
+
+class ChunkWalker {
+public:
+    ChunkWalker(std::string_view data, RiffLayout& layout) : data_(data), reader_(data), layout_(layout) {}
+
+    // The chunks in [offset, end). At the top of the file, only RIFF chunks
+    // are expected: anything else ends the walk.
+    void Walk(uint64_t offset, uint64_t end, int depth, const std::string& parent_list) {
+        const size_t file_size = data_.size();
+        while (end - offset >= chunk_header_size && reader_.Has(offset, chunk_header_size)) {
+            RiffChunk chunk;
+            chunk.offset = offset;
+            chunk.id = std::string(data_.substr(offset, 4));
+            chunk.size = reader_.U32(offset + 4);
+            chunk.depth = depth;
+            const uint64_t data_offset = offset + chunk_header_size;
+
+            if (depth == 0 && chunk.id != "RIFF" && chunk.id != "RF64") {
+                if (auto region = ClippedRegion(offset, file_size - offset, file_size,
+                                                "trailing data", RegionKind::Other)) {
+                    regions_.push_back(*region);
+                }
+                break;
+            }
+            // The ds64 chunk, first in an RF64 file, holds the sizes too
+            // large for the chunk headers.
+            if (chunk.id == "RF64" && reader_.Has(data_offset + 4, chunk_header_size + 16) &&
+                data_.substr(data_offset + 4, 4) == "ds64") {
+                riff_size_ = reader_.U64(data_offset + 12);
+                data_size_ = reader_.U64(data_offset + 20);
+            }
+            if (chunk.size == rf64_saturated) {
+                if (chunk.id == "RF64" && riff_size_) {
+                    chunk.size = *riff_size_;
+                } else if (chunk.id == "data" && data_size_) {
+                    chunk.size = *data_size_;
+                }
+            }
+            const bool is_list = chunk.id == "RIFF" || chunk.id == "RF64" || chunk.id == "LIST";
+            if (is_list && chunk.size >= 4 && reader_.Has(data_offset, 4)) {
+                chunk.list_type = std::string(data_.substr(data_offset, 4));
+            }
+            chunk.truncated = chunk.size > end - data_offset;
+
+            std::string name = ChunkName(chunk);
+            const uint64_t region_size = chunk.truncated ? end - offset : chunk_header_size + chunk.size;
+            if (auto region = ClippedRegion(offset, region_size, file_size,
+                                            chunk.truncated ? name + " (truncated)" : name,
+                                            chunk.truncated ? RegionKind::Corrupt : ChunkKind(chunk, parent_list))) {
+                regions_.push_back(*region);
+            }
+            if (depth == 0 && layout_.form.empty()) {
+                layout_.form = chunk.list_type;
+            }
+            layout_.chunks.push_back(chunk);
+
+            const uint64_t chunk_end = chunk.truncated ? end : data_offset + chunk.size;
+            if (!chunk.list_type.empty() && chunk.list_type != "movi" && depth < max_depth) {
+                Walk(data_offset + 4, chunk_end, depth + 1, chunk.list_type);
+            }
+            if (chunk.truncated) {
+                break;
+            }
+            // Chunks are padded to an even size.
+            offset = chunk_end + (chunk.size & 1);
+            if (offset > end) {
+                break;
+            }
+        }
+    }
+
+    std::vector<Region> TakeRegions() { return std::move(regions_); }
+
+private:
+    std::string_view data_;
+    ByteReader reader_;
+    RiffLayout& layout_;
+    std::vector<Region> regions_;
+    std::optional<uint64_t> riff_size_;
+    std::optional<uint64_t> data_size_;
+};
+
+}  // namespace
+
+bool IsRiff(std::string_view data) {
+    return data.size() >= 12 && (data.substr(0, 4) == "RIFF" || data.substr(0, 4) == "RF64");
+}
+
+std::string_view RiffForm(std::string_view data) {
+    return IsRiff(data) ? data.substr(8, 4) : std::string_view();
+}
+
+std::optional<RiffLayout> ParseRiffLayout(std::string_view data) {
+    if (!IsRiff(data)) {
+        return std::nullopt;
+    }
+    RiffLayout layout;
+    ChunkWalker walker(data, layout);
+    walker.Walk(0, data.size(), 0, "");
+    // A list is larger than the chunks in it: they are painted over it.
+    layout.regions.PaintNested(walker.TakeRegions());
+    return layout;
+}
@@ -0,0 +1,95 @@
+#include "symbol_index.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// FNV-1a: names are short, and the table only needs a good spread of the
+// low bits.
+uint64_t HashName(std::string_view name) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+}  // namespace
+
+void SymbolIndex::Add(std::string_view name, uint64_t offset, uint64_t size) {
+    // Entries hold 32-bit offsets into the names.
+    if (names_.size() + name.size() > std::numeric_limits<uint32_t>::max() ||
+        entries_.size() == std::numeric_limits<uint32_t>::max() - 1) {
+        return;
+    }
+    entries_.push_back({ static_cast<uint32_t>(names_.size()), static_cast<uint32_t>(name.size()), offset, size });
+    names_ += name;
+}
+
+void SymbolIndex::Finish() {
+    size_t capacity = 16;
+    while (capacity < entries_.size() * 2) {
+        capacity *= 2;
+    }
+    slots_.assign(capacity, 0);
+    const size_t mask = capacity - 1;
+    for (uint32_t i = 0; i < entries_.size(); ++i) {
+        const std::string_view name = Name(entries_[i]);
+        for (size_t slot = HashName(name) & mask;; slot = (slot + 1) & mask) {
+            if (slots_[slot] == 0) {
+                slots_[slot] = i + 1;
+                break;
+            }
+            if (Name(entries_[slots_[slot] - 1]) == name) {
+                break;  // The first one is kept.
+            }
+        }
+    }
+
+    sorted_.resize(entries_.size());
+    for (uint32_t i = 0; i < entries_.size(); ++i) {
+        sorted_[i] = i;
+    }
+    std::stable_sort(sorted_.begin(), sorted_.end(), [this](uint32_t a, uint32_t b) {
+        return Name(entries_[a]) < Name(entries_[b]);
+    });
+}
+
+std::optional<Symbol> SymbolIndex::Find(std::string_view name) const {
+    if (slots_.empty()) {
+        return std::nullopt;
+    }
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = HashName(name) & mask; slots_[slot] != 0; slot = (slot + 1) & mask) {
+        const Entry& entry = entries_[slots_[slot] - 1];
+        if (Name(entry) == name) {
+            return ToSymbol(entry);
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<Symbol> SymbolIndex::Complete(std::string_view prefix, size_t limit) const {
+    auto it = std::lower_bound(sorted_.begin(), sorted_.end(), prefix, [this](uint32_t index, std::string_view value) {
+        return Name(entries_[index]) < value;
+    });
+    std::vector<Symbol> symbols;
+    for (; it != sorted_.end() && symbols.size() < limit; ++it) {
+        const Entry& entry = entries_[*it];
+        if (Name(entry).substr(0, prefix.size()) != prefix) {
+            break;
+        }
+        symbols.push_back(ToSymbol(entry));
+    }
+    return symbols;
+}
+
+std::string_view SymbolIndex::Name(const Entry& entry) const {
+    return std::string_view(names_).substr(entry.name, entry.name_size);
+}
+
+Symbol SymbolIndex::ToSymbol(const Entry& entry) const {
+    return { Name(entry), entry.offset, entry.size };
+}
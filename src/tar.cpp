@@ -0,0 +1,222 @@
+#include "tar.hpp"
+
+#include "byte_reader.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace {
+
+const uint64_t block_size = 512;
+
+// Header fields
+const size_t name_offset = 0;
+const size_t name_size = 100;
+const size_t size_offset = 124;
+const size_t size_size = 12;
+const size_t checksum_offset = 148;
+const size_t checksum_size = 8;
+const size_t type_offset = 156;
+const size_t magic_offset = 257;
+const size_t prefix_offset = 345;
+const size_t prefix_size = 155;
+
+// Extended headers hold names and sizes: larger ones are skipped, not read.
+const uint64_t max_extended_size = 1 << 20;
+
+std::string Field(std::string_view header, size_t offset, size_t size) {
+    std::string_view field = header.substr(offset, size);
+    return std::string(field.substr(0, field.find('\0')));
+}
+
+// Octal digits, padded with spaces and NULs. GNU tar writes sizes of 8 GiB
+// and more as a big-endian base-256 number, after a set high bit.
+std::optional<uint64_t> Number(std::string_view field) {
+    const unsigned char first = static_cast<unsigned char>(field[0]);
+    if (first & 0x80) {
+        if (first == 0xff) {
+            return std::nullopt;  // Negative
+        }
+        uint64_t value = first & 0x7f;
+        for (size_t i = 1; i < field.size(); ++i) {
+            if (value >> 56) {
+                return std::nullopt;
+            }
+            value = (value << 8) | static_cast<unsigned char>(field[i]);
+        }
+        return value;
+    }
+    size_t i = 0;
+    while (i < field.size() && field[i] == ' ') {
+        ++i;
+    }
+    uint64_t value = 0;
+    for (; i < field.size() && field[i] >= '0' && field[i] <= '7'; ++i) {
+        if (value >> 61) {
+            return std::nullopt;
+        }
+        value = value * 8 + (field[i] - '0');
+    }
+    if (i < field.size() && field[i] != ' ' && field[i] != '\0') {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// The checksum field counts as spaces. Old archivers summed signed chars.
+bool ChecksumMatches(std::string_view header) {
+    auto expected = Number(header.substr(checksum_offset, checksum_size));
+    if (!expected) {
+        return false;
+    }
+    uint64_t sum = 0;
+    int64_t signed_sum = 0;
+    for (size_t i = 0; i < block_size; ++i) {
+        const bool in_field = i >= checksum_offset && i < checksum_offset + checksum_size;
+        const char byte = in_field ? ' ' : header[i];
+        sum += static_cast<unsigned char>(byte);
+        signed_sum += static_cast<signed char>(byte);
+    }
+    return *expected == sum || static_cast<int64_t>(*expected) == signed_sum;
+}
+
+// POSIX headers split long names in a prefix and a name. GNU headers use
+// the prefix field for other things.
+std::string EntryName(std::string_view header) {
+    std::string name = Field(header, name_offset, name_size);
+    if (header.substr(magic_offset, 6) == std::string_view("ustar\0", 6)) {
+        std::string prefix = Field(header, prefix_offset, prefix_size);
+        if (!prefix.empty()) {
+            return prefix + "/" + name;
+        }
+    }
+    return name;
+}
+
+// The path and size records of a pax extended header: "<length> <key>=<value>\n".
+void ReadPaxRecords(std::string_view records, std::optional<std::string>& path,
+                    std::optional<uint64_t>& size) {
+    while (!records.empty()) {
+        const size_t space = records.find(' ');
+        size_t length = 0;
+        if (space == std::string_view::npos ||
+            std::from_chars(records.data(), records.data() + space, length).ptr != records.data() + space ||
+            length <= space + 1 || length > records.size()) {
+            return;
+        }
+        std::string_view record = records.substr(space + 1, length - space - 1);
+        if (record.back() == '\n') {
+            record.remove_suffix(1);
+        }
+        const size_t equals = record.find('=');
+        if (equals != std::string_view::npos) {
+            const std::string_view key = record.substr(0, equals);
+            const std::string_view value = record.substr(equals + 1);
+            uint64_t number = 0;
+            if (key == "path") {
+                path = std::string(value);
+            } else if (key == "size" &&
+                       std::from_chars(value.data(), value.data() + value.size(), number).ec == std::errc()) {
+                size = number;
+            }
+        }
+        records.remove_prefix(length);
+    }
+}
+
+// Set by extended headers, for the entry after them.
+struct Extended {
+    std::optional<std::string> name;
+    std::optional<uint64_t> size;
+    // Of the first one
+    std::optional<uint64_t> offset;
+};
+
+// Links, directories and devices are followed by no data, whatever their size.
+bool HasData(char type) {
+    return type < '1' || type > '6';
+}
+
+}  // namespace
+
+bool IsTar(std::string_view data) {
+    return data.size() >= block_size && data.substr(magic_offset, 5) == "ustar" &&
+           ChecksumMatches(data.substr(0, block_size));
+}
+
+std::optional<TarLayout> ParseTarLayout(std::string_view data, const std::atomic<bool>* cancel) {
+    if (!IsTar(data)) {
+        return std::nullopt;
+    }
+    TarLayout layout;
+    ByteReader reader(data);
+    const size_t file_size = data.size();
+    std::vector<Region> regions;
+
+    Extended extended;
+
+    uint64_t offset = 0;
+    while (reader.Has(offset, block_size)) {
+        if (Cancelled(cancel)) {
+            return std::nullopt;
+        }
+        const std::string_view header = data.substr(offset, block_size);
+        if (std::all_of(header.begin(), header.end(), [](char c) { return c == '\0'; })) {
+            // Two zero blocks, and the padding of the last record.
+            regions.push_back(*ClippedRegion(offset, file_size - offset, file_size,
+                                             "end of archive", RegionKind::Other));
+            break;
+        }
+        auto size = Number(header.substr(size_offset, size_size));
+        if (!size || !ChecksumMatches(header)) {
+            layout.corrupt = true;
+            regions.push_back(*ClippedRegion(offset, block_size, file_size, "bad header", RegionKind::Corrupt));
+            break;
+        }
+        const char type = header[type_offset];
+        const uint64_t data_offset = offset + block_size;
+
+        if (type == 'x' || type == 'g' || type == 'L' || type == 'K') {
+            if (*size <= max_extended_size && reader.Has(data_offset, *size)) {
+                const std::string_view payload = data.substr(data_offset, *size);
+                if (type == 'x') {
+                    ReadPaxRecords(payload, extended.name, extended.size);
+                } else if (type == 'L') {
+                    extended.name = std::string(payload.substr(0, payload.find('\0')));
+                }
+            }
+            if (type == 'g') {
+                // Applies to every entry after it.
+                if (auto region = ClippedRegion(offset, block_size + *size, file_size,
+                                                "pax global header", RegionKind::Table)) {
+                    regions.push_back(*region);
+                }
+            } else if (!extended.offset) {
+                extended.offset = offset;
+            }
+        } else {
+            TarEntry entry;
+            entry.name = extended.name ? *extended.name : EntryName(header);
+            entry.type = type;
+            entry.size = HasData(type) ? extended.size.value_or(*size) : 0;
+            entry.header_offset = extended.offset.value_or(offset);
+            entry.data_offset = data_offset;
+            regions.push_back(*ClippedRegion(entry.header_offset, data_offset - entry.header_offset, file_size,
+                                             entry.name + " header", RegionKind::Header));
+            if (auto region = ClippedRegion(data_offset, entry.size, file_size, entry.name, RegionKind::Data)) {
+                regions.push_back(*region);
+            }
+            size = entry.size;
+            layout.entries.push_back(std::move(entry));
+            extended = {};
+        }
+
+        // The data is padded to a whole block.
+        if (*size > file_size - data_offset) {
+            break;
+        }
+        offset = data_offset + (*size + block_size - 1) / block_size * block_size;
+    }
+    layout.regions.PaintNested(std::move(regions));
+    return layout;
+}
@@ -0,0 +1,338 @@
+#include "zip.hpp"
+
+#include "byte_reader.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+
+namespace {
+
+const uint32_t local_header_signature = 0x04034b50;
+const uint32_t central_header_signature = 0x02014b50;
+const uint32_t end_signature = 0x06054b50;
+const uint32_t zip64_end_signature = 0x06064b50;
+const uint32_t zip64_locator_signature = 0x07064b50;
+const uint32_t data_descriptor_signature = 0x08074b50;
+
+const size_t local_header_size = 30;
+const size_t central_header_size = 46;
+const size_t end_size = 22;
+const size_t zip64_end_size = 56;
+const size_t zip64_locator_size = 20;
+// The archive comment after the end record is at most this long.
+const uint64_t max_comment_size = 0xffff;
+
+// The sizes are in a data descriptor after the entry data.
+const uint16_t flag_data_descriptor = 0x0008;
+const uint16_t zip64_extra_id = 0x0001;
+// A 32-bit field whose value is in the ZIP64 extra field.
+const uint64_t zip64_saturated = 0xffffffff;
+
+// The end records, and the central directory they point to.
+struct EndRecords {
+    uint64_t end;
+    std::optional<uint64_t> zip64_locator;
+    std::optional<uint64_t> zip64_end;
+    uint64_t directory_offset;  // In the file
+    uint64_t directory_size;
+    uint64_t prefix_size;
+};
+
+// The end record the closest to the end of the file whose comment fits in
+// the file: an earlier match is likely to be inside the comment.
+std::optional<uint64_t> FindEnd(const ByteReader& reader) {
+    if (reader.size() < end_size) {
+        return std::nullopt;
+    }
+    const uint64_t last = reader.size() - end_size;
+    const uint64_t first = last - std::min(last, max_comment_size);
+    for (uint64_t offset = last + 1; offset-- > first;) {
+        if (reader.U8(offset) == 'P' && reader.U32(offset) == end_signature &&
+            reader.U16(offset + 20) <= last - offset) {
+            return offset;
+        }
+    }
+    return std::nullopt;
+}
+
+bool HasZip64End(const ByteReader& reader, uint64_t offset) {
+    return reader.Has(offset, zip64_end_size) && reader.U32(offset) == zip64_end_signature;
+}
+
+std::optional<EndRecords> ReadEnd(const ByteReader& reader) {
+    auto end = FindEnd(reader);
+    if (!end) {
+        return std::nullopt;
+    }
+    EndRecords records{};
+    records.end = *end;
+    records.directory_size = reader.U32(*end + 12);
+    uint64_t directory_offset = reader.U32(*end + 16);
+    // The central directory is right before the end records.
+    uint64_t directory_end = *end;
+
+    if (*end >= zip64_locator_size && reader.U32(*end - zip64_locator_size) == zip64_locator_signature) {
+        const uint64_t locator = *end - zip64_locator_size;
+        records.zip64_locator = locator;
+        // Its offset doesn't count data prepended to the archive: the record
+        // is then found before the locator.
+        uint64_t record = reader.U64(locator + 8);
+        if (!HasZip64End(reader, record) && locator >= zip64_end_size) {
+            record = locator - zip64_end_size;
+        }
+        if (HasZip64End(reader, record)) {
+            records.zip64_end = record;
+            records.directory_size = reader.U64(record + 40);
+            directory_offset = reader.U64(record + 48);
+            directory_end = record;
+        }
+    }
+
+    if (records.directory_size > directory_end || directory_offset > directory_end - records.directory_size) {
+        return std::nullopt;
+    }
+    records.directory_offset = directory_end - records.directory_size;
+    records.prefix_size = records.directory_offset - directory_offset;
+    return records;
+}
+
+// The size of the local header at offset, if there is one.
+std::optional<uint64_t> LocalHeaderSize(const ByteReader& reader, uint64_t offset) {
+    if (!reader.Has(offset, local_header_size) || reader.U32(offset) != local_header_signature) {
+        return std::nullopt;
+    }
+    return local_header_size + reader.U16(offset + 26) + reader.U16(offset + 28);
+}
+
+// Replace the fields saturated to 0xffffffff by their value in the ZIP64
+// extra field. They are stored in the order given, the others are skipped.
+void ReadZip64Extra(const ByteReader& reader, uint64_t offset, uint64_t size,
+                    std::initializer_list<uint64_t*> fields) {
+    const uint64_t end = offset + size;
+    while (offset + 4 <= end && reader.Has(offset, 4)) {
+        const uint16_t id = reader.U16(offset);
+        const uint64_t field_end = std::min(end, offset + 4 + reader.U16(offset + 2));
+        if (id == zip64_extra_id) {
+            uint64_t value = offset + 4;
+            for (uint64_t* field : fields) {
+                if (*field != zip64_saturated) {
+                    continue;
+                }
+                if (value + 8 > field_end || !reader.Has(value, 8)) {
+                    return;
+                }
+                *field = reader.U64(value);
+                value += 8;
+            }
+            return;
+        }
+        offset = field_end;
+    }
+}
+
+void ParseCentralDirectory(const ByteReader& reader, const EndRecords& records, ZipLayout& layout,
+                           std::vector<Region>& regions, const std::atomic<bool>* cancel) {
+    // The entry count is left: it wraps in archives with many entries
+    // written without ZIP64 records.
+    const uint64_t directory_end = records.directory_offset + records.directory_size;
+    uint64_t offset = records.directory_offset;
+    while (offset < directory_end && reader.Has(offset, central_header_size) &&
+           reader.U32(offset) == central_header_signature && !Cancelled(cancel)) {
+        const uint64_t name_size = reader.U16(offset + 28);
+        const uint64_t extra_size = reader.U16(offset + 30);
+        const uint64_t comment_size = reader.U16(offset + 32);
+        const uint64_t name = offset + central_header_size;
+
+        ZipEntry entry;
+        entry.name = reader.String(name, name + name_size);
+        entry.flags = reader.U16(offset + 8);
+        entry.method = reader.U16(offset + 10);
+        entry.crc = reader.U32(offset + 16);
+        entry.compressed_size = reader.U32(offset + 20);
+        entry.uncompressed_size = reader.U32(offset + 24);
+        entry.central_offset = offset;
+        uint64_t local_offset = reader.U32(offset + 42);
+        ReadZip64Extra(reader, name + name_size, extra_size,
+                       { &entry.uncompressed_size, &entry.compressed_size, &local_offset });
+        entry.local_offset = records.prefix_size + local_offset;
+
+        const uint64_t record_size = central_header_size + name_size + extra_size + comment_size;
+        if (auto region = ClippedRegion(offset, record_size, reader.size(),
+                                        entry.name + " central header", RegionKind::Table)) {
+            regions.push_back(*region);
+        }
+        layout.entries.push_back(std::move(entry));
+        offset += record_size;
+    }
+}
+
+// The local header, data and data descriptor of entry. Returns where the
+// entry ends.
+uint64_t AddLocalRegions(const ByteReader& reader, const ZipEntry& entry, uint64_t header_size,
+                         std::vector<Region>& regions) {
+    const size_t file_size = reader.size();
+    if (auto region = ClippedRegion(entry.local_offset, header_size, file_size,
+                                    entry.name + " local header", RegionKind::Header)) {
+        regions.push_back(*region);
+    }
+    const uint64_t data = entry.local_offset + header_size;
+    if (auto region = ClippedRegion(data, entry.compressed_size, file_size, entry.name, RegionKind::Data)) {
+        regions.push_back(*region);
+    }
+    if (data > file_size || entry.compressed_size > file_size - data) {
+        return file_size;
+    }
+
+    uint64_t end = data + entry.compressed_size;
+    if (entry.flags & flag_data_descriptor) {
+        // CRC and sizes, 64-bit for ZIP64 entries, after an optional signature.
+        const bool zip64 = entry.compressed_size >= zip64_saturated || entry.uncompressed_size >= zip64_saturated;
+        uint64_t size = zip64 ? 20 : 12;
+        if (reader.Has(end, 4) && reader.U32(end) == data_descriptor_signature) {
+            size += 4;
+        }
+        if (auto region = ClippedRegion(end, size, file_size, entry.name + " data descriptor", RegionKind::Table)) {
+            regions.push_back(*region);
+        }
+        end += size;
+    }
+    return end;
+}
+
+// Without a central directory (a truncated download), the entries are found
+// one after the other from their local headers. The walk stops at the first
+// entry whose size is only in its data descriptor.
+void WalkLocalHeaders(const ByteReader& reader, ZipLayout& layout, std::vector<Region>& regions,
+                      const std::atomic<bool>* cancel) {
+    uint64_t offset = 0;
+    while (auto header_size = LocalHeaderSize(reader, offset)) {
+        if (Cancelled(cancel)) {
+            return;
+        }
+        const uint64_t name_size = reader.U16(offset + 26);
+        const uint64_t name = offset + local_header_size;
+
+        ZipEntry entry;
+        entry.name = reader.String(name, name + name_size);
+        entry.flags = reader.U16(offset + 6);
+        entry.method = reader.U16(offset + 8);
+        entry.crc = reader.U32(offset + 14);
+        entry.compressed_size = reader.U32(offset + 18);
+        entry.uncompressed_size = reader.U32(offset + 22);
+        entry.local_offset = offset;
+        ReadZip64Extra(reader, name + name_size, reader.U16(offset + 28),
+                       { &entry.uncompressed_size, &entry.compressed_size });
+
+        const bool streamed = (entry.flags & flag_data_descriptor) && entry.compressed_size == 0;
+        if (streamed) {
+            if (auto region = ClippedRegion(offset, *header_size, reader.size(),
+                                            entry.name + " local header", RegionKind::Header)) {
+                regions.push_back(*region);
+            }
+            layout.entries.push_back(std::move(entry));
+            break;
+        }
+        offset = AddLocalRegions(reader, entry, *header_size, regions);
+        layout.entries.push_back(std::move(entry));
+    }
+}
+
+// Before the local headers are read, an entry is everything up to the next
+// one, or to the central directory.
+void AddEntrySpans(const ZipLayout& layout, size_t file_size, std::vector<Region>& regions) {
+    std::vector<uint64_t> starts;
+    for (const ZipEntry& entry : layout.entries) {
+        starts.push_back(entry.local_offset);
+    }
+    std::sort(starts.begin(), starts.end());
+    for (const ZipEntry& entry : layout.entries) {
+        auto next = std::upper_bound(starts.begin(), starts.end(), entry.local_offset);
+        const uint64_t end = next != starts.end() ? *next : layout.central_directory_offset;
+        if (end <= entry.local_offset) {
+            continue;
+        }
+        if (auto region = ClippedRegion(entry.local_offset, end - entry.local_offset, file_size,
+                                        entry.name, RegionKind::Data)) {
+            regions.push_back(*region);
+        }
+    }
+}
+
+// Nothing once cancelled: the entries may have been cut short.
+std::optional<ZipLayout> ParseZip(std::string_view data, bool with_local_headers, const std::atomic<bool>* cancel) {
+    ByteReader reader(data);
+    auto records = ReadEnd(reader);
+    if (!records && !LocalHeaderSize(reader, 0)) {
+        return std::nullopt;
+    }
+    ZipLayout layout;
+    std::vector<Region> regions;
+    if (!records) {
+        WalkLocalHeaders(reader, layout, regions, cancel);
+        if (Cancelled(cancel)) {
+            return std::nullopt;
+        }
+        layout.regions.PaintNested(std::move(regions));
+        return layout;
+    }
+
+    layout.end_offset = records->end;
+    layout.zip64 = records->zip64_end.has_value();
+    layout.prefix_size = records->prefix_size;
+    layout.central_directory_offset = records->directory_offset;
+    layout.central_directory_size = records->directory_size;
+
+    const size_t file_size = data.size();
+    if (auto region = ClippedRegion(0, layout.prefix_size, file_size, "data before the archive", RegionKind::Other)) {
+        regions.push_back(*region);
+    }
+    regions.push_back(*ClippedRegion(records->end, end_size, file_size, "end of central directory", RegionKind::Header));
+    if (auto region = ClippedRegion(records->end + end_size, reader.U16(records->end + 20), file_size,
+                                    "archive comment", RegionKind::Strings)) {
+        regions.push_back(*region);
+    }
+    if (records->zip64_locator) {
+        regions.push_back(*ClippedRegion(*records->zip64_locator, zip64_locator_size, file_size,
+                                         "ZIP64 end locator", RegionKind::Header));
+    }
+    if (records->zip64_end) {
+        if (auto region = ClippedRegion(*records->zip64_end, zip64_end_size, file_size,
+                                        "ZIP64 end of central directory", RegionKind::Header)) {
+            regions.push_back(*region);
+        }
+    }
+
+    ParseCentralDirectory(reader, *records, layout, regions, cancel);
+    if (with_local_headers) {
+        for (const ZipEntry& entry : layout.entries) {
+            if (Cancelled(cancel)) {
+                break;
+            }
+            if (auto header_size = LocalHeaderSize(reader, entry.local_offset)) {
+                AddLocalRegions(reader, entry, *header_size, regions);
+            }
+        }
+    } else {
+        AddEntrySpans(layout, file_size, regions);
+    }
+    if (Cancelled(cancel)) {
+        return std::nullopt;
+    }
+    layout.regions.PaintNested(std::move(regions));
+    return layout;
+}
+
+}  // namespace
+
+bool IsZip(std::string_view data) {
+    ByteReader reader(data);
+    return LocalHeaderSize(reader, 0) || ReadEnd(reader);
+}
+
+std::optional<ZipLayout> ParseZipLayout(std::string_view data, const std::atomic<bool>* cancel) {
+    return ParseZip(data, true, cancel);
+}
+
+std::optional<ZipLayout> ParseZipDirectory(std::string_view data, const std::atomic<bool>* cancel) {
+    return ParseZip(data, false, cancel);
+}